@@ -21,4 +21,11 @@ Constraint::Constraint(Constraint&& other) : id(other.id) {
     std::swap(name, other.name);
 }
 
+Constraint& Constraint::operator=(Constraint&& other){
+    id = other.id;
+    std::swap(name, other.name);
+
+    return *this;
+}
+
 }
\ No newline at end of file
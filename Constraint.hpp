@@ -32,7 +32,7 @@ class Constraint {
         uint32_t getID() const { return id;}
 
         /// Get the name of the constraint
-        std::string getName() const { return name; }
+        const std::string& getName() const { return name; }
         //@}
 
         /// Set the name of the constraint
@@ -57,6 +57,9 @@ class Constraint {
 
         /// Move constructor
         Constraint(Constraint&& other);
+
+        /// Move assignment operator
+        Constraint& operator=(Constraint&& other);
         //@}
 
     private:
@@ -1,27 +1,279 @@
 #include "DCSRMatrix.hpp"
 
+#include <atomic>
 #include <exception>
 #include <algorithm>
 #include <cmath>
+#include <stdexcept>
+
+#include "Parallel.hpp"
 
 #include <iostream>
 
 namespace Osi2 {
 
-DCSRMatrix::DCSRMatrix(){
+namespace {
+
+/// Stable parallel LSD radix sort of keys, 11 bits at a time, moving the values along. Only the lowest key_bits bits are sorted
+template <typename Value>
+void radixSort(std::vector<uint64_t>& keys, std::vector<Value>& vals, unsigned key_bits){
+    const unsigned DIGIT_BITS = 11;
+    const size_t RADIX = size_t(1) << DIGIT_BITS;
+    size_t n = keys.size();
+    size_t thread_count = threadCountFor(n, 1 << 16);
+    std::vector<uint64_t> keys_tmp(n);
+    std::vector<Value> vals_tmp(n);
+    std::vector<size_t> counts(thread_count * RADIX);
+
+    for (unsigned shift = 0; shift < key_bits; shift += DIGIT_BITS){
+        std::fill(std::begin(counts), std::end(counts), 0);
+
+        parallelFor(thread_count, [&](size_t t){ // Histogram of the digits of each chunk
+            size_t* count = counts.data() + t * RADIX;
+            for (size_t k = n * t / thread_count; k < n * (t + 1) / thread_count; k++){
+                ++count[(keys[k] >> shift) & (RADIX - 1)];
+            }
+        });
+
+        size_t offset = 0;
+        for (size_t d = 0; d < RADIX; d++){ // Start of each (digit, chunk) : digits in order, and chunks in order inside a digit for stability
+            for (size_t t = 0; t < thread_count; t++){
+                size_t c = counts[t * RADIX + d];
+                counts[t * RADIX + d] = offset;
+                offset += c;
+            }
+        }
+
+        parallelFor(thread_count, [&](size_t t){ // Scatter each chunk
+            size_t* pos = counts.data() + t * RADIX;
+            for (size_t k = n * t / thread_count; k < n * (t + 1) / thread_count; k++){
+                size_t p = pos[(keys[k] >> shift) & (RADIX - 1)]++;
+                keys_tmp[p] = keys[k];
+                vals_tmp[p] = vals[k];
+            }
+        });
+
+        keys.swap(keys_tmp);
+        vals.swap(vals_tmp);
+    }
+}
+
+/// Number of bits needed to write n
+unsigned bitWidth(uint64_t n){
+    unsigned ret_val = 0;
+    while (n != 0){
+        ++ret_val;
+        n >>= 1;
+    }
+    return ret_val;
+}
+
+}
+
+template <typename Index, typename Value>
+struct BasicDCSRMatrix<Index, Value>::AppendState {
+    static const size_t SLOT_SHIFT = 18; ///< 2^18 elements per slot chunk
+    static const size_t ROW_SHIFT = 16; ///< 2^16 rows per row chunk
+    static const size_t MAX_CHUNKS = size_t(1) << 16; ///< Size of the chunk directories, that are never reallocated
+
+    /// Elements of the appended rows. The rows are laid out one after the other in a linear space cut in chunks
+    struct SlotChunk {
+        Index cols[size_t(1) << SLOT_SHIFT];
+        Value vals[size_t(1) << SLOT_SHIFT];
+    };
+
+    /// Place of an appended row in the linear space
+    struct RowEntry {
+        uint64_t pos; ///< Position of the first element
+        Index size; ///< Number of elements
+        Index zeros; ///< Number of explicit zeros (tombstones)
+    };
+
+    struct RowChunk {
+        RowEntry rows[size_t(1) << ROW_SHIFT];
+    };
+
+    std::atomic<uint64_t> next_row; ///< Number of rows reserved
+    std::atomic<uint64_t> next_slot; ///< Number of elements reserved
+    std::atomic<size_t> col_count; ///< Greatest dimension of the appended rows
+    std::atomic<bool> failed; ///< Set when a concurrentAddRow threw after its reservation, its row entry is then never written
+    std::unique_ptr<std::atomic<SlotChunk*>[]> slot_chunks; ///< Directory of the slot chunks, allocated on first use
+    std::unique_ptr<std::atomic<RowChunk*>[]> row_chunks; ///< Directory of the row chunks, allocated on first use
+
+    AppendState() : next_row(0), next_slot(0), col_count(0), failed(false), slot_chunks(new std::atomic<SlotChunk*>[MAX_CHUNKS]), row_chunks(new std::atomic<RowChunk*>[MAX_CHUNKS]) {
+        for (size_t k = 0; k < MAX_CHUNKS; k++){
+            slot_chunks[k].store(nullptr, std::memory_order_relaxed);
+            row_chunks[k].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    ~AppendState(){
+        for (size_t k = 0; k < MAX_CHUNKS; k++){
+            delete slot_chunks[k].load(std::memory_order_relaxed);
+            delete row_chunks[k].load(std::memory_order_relaxed);
+        }
+    }
+
+    /// Get the k-th chunk of a directory. The first thread that needs it allocates it, the others use the one it published
+    template <typename Chunk>
+    static Chunk* chunk(std::atomic<Chunk*>* directory, size_t k){
+        if (k >= MAX_CHUNKS){
+            throw std::out_of_range("Too many elements or rows appended concurrently, call seal() more often");
+        }
+        Chunk* ret_val = directory[k].load(std::memory_order_acquire);
+        if (ret_val == nullptr){
+            Chunk* created = new Chunk;
+            if (directory[k].compare_exchange_strong(ret_val, created, std::memory_order_acq_rel, std::memory_order_acquire)){
+                ret_val = created;
+            }
+            else{ // An other thread published it first, ret_val now holds its chunk
+                delete created;
+            }
+        }
+        return ret_val;
+    }
+
+    RowEntry& row(uint64_t r){
+        return chunk(row_chunks.get(), r >> ROW_SHIFT)->rows[r & ((uint64_t(1) << ROW_SHIFT) - 1)];
+    }
+
+    SlotChunk* slots(uint64_t pos){
+        return chunk(slot_chunks.get(), pos >> SLOT_SHIFT);
+    }
+};
+
+template <typename Index, typename Value>
+BasicDCSRMatrix<Index, Value>::BasicDCSRMatrix(){
     matrix_size_row = 0;
     matrix_size_col = 0;
 }
 
-DCSRMatrix::DCSRMatrix(size_t nb_rows, size_t nb_cols){
+template <typename Index, typename Value>
+BasicDCSRMatrix<Index, Value>::BasicDCSRMatrix(size_t nb_rows, size_t nb_cols){
     matrix_size_row = nb_rows;
     matrix_size_col = nb_cols;
 
     row_indices.reserve(nb_rows);
+    dirty.reserve(nb_rows);
  }
 
 
-bool DCSRMatrix::addRow(const PackedVector& v){
+template <typename Index, typename Value>
+BasicDCSRMatrix<Index, Value> BasicDCSRMatrix<Index, Value>::fromTriplets(const std::vector<Index>& rows, const std::vector<Index>& cols, const std::vector<Value>& vals, size_t nb_rows, size_t nb_cols){
+    if (rows.size() != cols.size() || rows.size() != vals.size()){
+        throw std::invalid_argument("Triplet arrays of different sizes : " + std::to_string(rows.size()) + " rows, " + std::to_string(cols.size()) + " columns, " + std::to_string(vals.size()) + " values");
+    }
+
+    size_t n = rows.size();
+    for (size_t k = 0; k < n; k++){ // Dimensions of the matrix
+        nb_rows = std::max(nb_rows, size_t(rows[k]) + 1);
+        nb_cols = std::max(nb_cols, size_t(cols[k]) + 1);
+    }
+
+    unsigned col_bits = bitWidth(nb_cols);
+    unsigned row_bits = bitWidth(nb_rows);
+    if (col_bits + row_bits > 64){
+        throw std::invalid_argument("Matrix of " + std::to_string(nb_rows) + " rows and " + std::to_string(nb_cols) + " columns is too large for 64 bit triplet keys");
+    }
+
+    std::vector<uint64_t> keys(n);
+    std::vector<Value> sorted_vals(vals);
+    bool sorted = true;
+    for (size_t k = 0; k < n; k++){ // Key of each triplet : row then column, packed on as few bits as possible
+        keys[k] = (uint64_t(rows[k]) << col_bits) | cols[k];
+        sorted = sorted && (k == 0 || keys[k - 1] <= keys[k]);
+    }
+    if (!sorted){
+        radixSort(keys, sorted_vals, col_bits + row_bits);
+    }
+
+    size_t unique = 0;
+    for (size_t k = 0; k < n; k++){ // Sum the duplicates, in their input order
+        if (unique != 0 && keys[unique - 1] == keys[k]){
+            sorted_vals[unique - 1] += sorted_vals[k];
+        }
+        else{
+            keys[unique] = keys[k];
+            sorted_vals[unique++] = sorted_vals[k];
+        }
+    }
+
+    size_t nonzero = 0;
+    for (size_t k = 0; k < unique; k++){ // Zeros are not stored
+        if (sorted_vals[k] != 0){
+            keys[nonzero] = keys[k];
+            sorted_vals[nonzero++] = sorted_vals[k];
+        }
+    }
+    unique = nonzero;
+
+    BasicDCSRMatrix ret_val(nb_rows, nb_cols);
+    std::vector<Index> row_start(nb_rows + 1, 0); // Start of each row in the sorted triplets
+    for (size_t k = 0; k < unique; k++){
+        ++row_start[(keys[k] >> col_bits) + 1];
+    }
+    for (size_t i = 0; i < nb_rows; i++){
+        row_start[i + 1] += row_start[i];
+    }
+
+    std::vector<Index> offsets(nb_rows + 1, 0); // Start of each row in the arrays of the matrix
+    for (size_t i = 0; i < nb_rows; i++){
+        offsets[i + 1] = offsets[i] + ret_val.capacityFor(row_start[i + 1] - row_start[i]);
+    }
+
+    ret_val.row_indices.resize(nb_rows);
+    ret_val.dirty.assign(nb_rows, 0);
+    ret_val.capacity.resize(nb_rows);
+    ret_val.col_indices.assign(offsets[nb_rows], 0);
+    ret_val.values.assign(offsets[nb_rows], 0);
+
+    uint64_t col_mask = col_bits == 64 ? ~uint64_t(0) : (uint64_t(1) << col_bits) - 1;
+    size_t thread_count = threadCountFor(unique, MIN_NNZ_PER_THREAD);
+    parallelFor(thread_count, [&](size_t t){ // Write the rows in place, each thread its own range of rows
+        for (size_t i = nb_rows * t / thread_count; i < nb_rows * (t + 1) / thread_count; i++){
+            Index pos = offsets[i];
+            for (Index k = row_start[i]; k < row_start[i + 1]; k++){
+                ret_val.col_indices[pos] = keys[k] & col_mask;
+                ret_val.values[pos++] = sorted_vals[k];
+            }
+            ret_val.row_indices[i].push_back(std::make_pair(offsets[i], row_start[i + 1] - row_start[i]));
+            ret_val.capacity[i] = offsets[i + 1] - offsets[i];
+        }
+    });
+
+    ret_val.row_count = nb_rows;
+    ret_val.col_count = nb_cols;
+    ret_val.end_of_rows = offsets[nb_rows];
+    ret_val.nnz = unique;
+    ret_val.segment_histogram.assign(2, 0);
+    ret_val.segment_histogram[1] = nb_rows;
+
+    return ret_val;
+}
+
+template <typename Index, typename Value>
+void BasicDCSRMatrix<Index, Value>::toTriplets(std::vector<Index>& rows, std::vector<Index>& cols, std::vector<Value>& vals) const {
+    rows.clear();
+    cols.clear();
+    vals.clear();
+    rows.reserve(nnz);
+    cols.reserve(nnz);
+    vals.reserve(nnz);
+
+    for (Index i = 0; i < row_indices.size(); i++){
+        for (const auto& e : getRowView(i)){
+            if (e.second == 0){ // Tombstone
+                continue;
+            }
+            rows.push_back(i);
+            cols.push_back(e.first);
+            vals.push_back(e.second);
+        }
+    }
+}
+
+template <typename Index, typename Value>
+bool BasicDCSRMatrix<Index, Value>::addRow(const PackedVector& v){
 
     bool ret_val = true;
 
@@ -34,87 +286,291 @@ bool DCSRMatrix::addRow(const PackedVector& v){
 
     Indices pair = std::make_pair(end_of_rows, v.size() );
 
-    std::vector<Indices> index_seg;
-    index_seg.reserve(index_segment_size);
-    index_seg.push_back(pair); 
+    std::vector<Indices> index_seg(1, pair); // A single segment, rows grow geometrically so they only get a few more
 
     row_indices.push_back(index_seg);
+    dirty.push_back(0);
+    capacity.push_back(capacityFor(v.size()));
+    moveInHistogram(0, 1);
+    padding += capacity.back() - v.size();
 
     if (row_count == matrix_size_row){ // If the matrix row capacity is reached, we increase the row capacity of the matrix
         matrix_size_row++;
     }
 
-    uint32_t bloc_allocated = std::floor((v.size() / segment_size)) + 1; // Number of "blocs" of size segment_size to allocate. Each bloc can hold segment_size values
-
-    end_of_rows = end_of_rows + bloc_allocated * segment_size; // Compute the end index of the row
+    end_of_rows = end_of_rows + capacity.back(); // Compute the end index of the row
 
     for ( const auto& e : v ){ // Push all the column indices and values in the corresponding vectors
         col_indices.push_back(e.first);
         values.push_back(e.second);
+        if ( e.second == 0 ){ // An explicit zero is handled as a tombstone
+            ++tombstones;
+            markDirty(row_indices.size() - 1);
+        }
+        else{
+            ++nnz;
+        }
     }
-    for( uint i = v.size(); i < bloc_allocated * segment_size ; i++){ // Create the empty space at the end of column indices and values arrays
-        col_indices.push_back(0);
-        values.push_back(0);
-    }
+    col_indices.resize(end_of_rows, 0); // Create the empty space at the end of column indices and values arrays
+    values.resize(end_of_rows, 0);
 
     row_count++;
 
+    csc_valid = false; // The new row adds an element in many columns, the column index is rebuilt on the next column access
+
     return ret_val;
 }
 
-bool DCSRMatrix::addColumn(const PackedVector& v){
+template <typename Index, typename Value>
+bool BasicDCSRMatrix<Index, Value>::addColumn(const PackedVector& v){
     bool ret_val = true;
 
     PackedVector empty;
-    while (v.dimension() > matrix_size_row) addRow(empty); // If the size of the column we add is larger than the matrix row capacity, add empty rows until it is the same amount
+    while (v.dimension() > row_indices.size()) addRow(empty); // If the size of the column we add is larger than the number of rows, add empty rows until it is the same amount
 
     for ( const auto& e : v){ // For each element in the vector
-        uint32_t index = e.first;
-        double value = e.second;
+        appendToRow(e.first, col_count, e.second);
+    }
+
+    if (csc_valid){ // The new column goes at the end of the column index, patch it in place
+        for ( const auto& e : v ){
+            if (e.second == 0){ // Stored as a tombstone, which buildColumnIndex skips
+                continue;
+            }
+            csc_rows.push_back(e.first);
+            csc_values.push_back(e.second);
+        }
+        csc_start.push_back(csc_rows.size());
+    }
+
+    col_count++;
+
+    if (col_count > matrix_size_col){ // If the column count is greater than the column capacity of the matrix, increase the column capacity
+        matrix_size_col++;
+    }
+
+    autoDefragment();
+
+    return ret_val;
+}
+
+template <typename Index, typename Value>
+void BasicDCSRMatrix<Index, Value>::beginConcurrentAppend(){
+    if (!append_state){
+        append_state = std::make_shared<AppendState>();
+    }
+}
+
+template <typename Index, typename Value>
+Index BasicDCSRMatrix<Index, Value>::concurrentAddRow(const PackedVector& v){
+    if (!append_state){
+        throw std::logic_error("concurrentAddRow called outside of the concurrent append mode, call beginConcurrentAppend first");
+    }
+    AppendState& state = *append_state;
+    const uint64_t MASK = (uint64_t(1) << AppendState::SLOT_SHIFT) - 1;
+
+    uint64_t row = state.next_row.fetch_add(1, std::memory_order_relaxed); // Reserve the row and the space of its elements
+    uint64_t pos = state.next_slot.fetch_add(v.size(), std::memory_order_relaxed);
+
+    try{ // The chunk allocations may throw, the reservation can not be undone
+        Index zeros = 0;
+        typename AppendState::SlotChunk* chunk = nullptr;
+        for (const auto& e : v){ // The row may span two chunks
+            if (chunk == nullptr || (pos & MASK) == 0){
+                chunk = state.slots(pos);
+            }
+            chunk->cols[pos & MASK] = e.first;
+            chunk->vals[pos & MASK] = e.second;
+            zeros += e.second == 0 ? 1 : 0;
+            ++pos;
+        }
+
+        typename AppendState::RowEntry& entry = state.row(row);
+        entry.pos = pos - v.size();
+        entry.size = v.size();
+        entry.zeros = zeros;
+    }
+    catch (...){
+        state.failed.store(true, std::memory_order_relaxed); // seal() synchronizes with the threads, so a relaxed store is enough
+        throw;
+    }
 
-        Indices& ind = row_indices[index][row_indices[index].size() - 1]; // Get right the row start index
-        if ( ind.second == 0 || ind.second % segment_size != 0 ){ // If we have space left in the "bloc" allocated, we insert the value 
-            uint32_t i = ind.first + ind.second;
-            col_indices [ i ] = col_count;
-            values[ i ] = value;
+    size_t dim = state.col_count.load(std::memory_order_relaxed);
+    while (v.dimension() > dim && !state.col_count.compare_exchange_weak(dim, v.dimension(), std::memory_order_relaxed)){} // Atomic maximum
 
-            ++ind.second;
+    return row_indices.size() + row;
+}
+
+template <typename Index, typename Value>
+void BasicDCSRMatrix<Index, Value>::seal(){
+    if (!append_state){
+        return;
+    }
+    AppendState& state = *append_state;
+    const uint64_t MASK = (uint64_t(1) << AppendState::SLOT_SHIFT) - 1;
+
+    if (state.failed.load()){
+        append_state.reset();
+        throw std::runtime_error("A concurrentAddRow failed, the rows appended since beginConcurrentAppend are dropped");
+    }
+
+    size_t added = state.next_row.load();
+    size_t base = row_indices.size();
+    size_t thread_count = threadCountFor(state.next_slot.load(), MIN_NNZ_PER_THREAD);
+    std::vector<Index> offsets(added + 1, 0); // Start of each appended row in the arrays of the matrix
+    std::vector<size_t> block_sums(thread_count + 1, 0); // Space of the rows of each thread
+
+    parallelFor(thread_count, [&](size_t t){
+        for (size_t r = added * t / thread_count; r < added * (t + 1) / thread_count; r++){
+            block_sums[t + 1] += capacityFor(state.row(r).size);
         }
-        else{ // If we have no space left in the "bloc", we need to allocate a new one
-            row_indices[index].push_back( std::make_pair(end_of_rows, 1) ); // Add a new pair of row start index and element count
+    });
+    block_sums[0] = end_of_rows;
+    for (size_t t = 0; t < thread_count; t++){
+        block_sums[t + 1] += block_sums[t];
+    }
 
-            col_indices.push_back(col_count); // Push the column index and valuein the corresponding arrays
-            values.push_back(value);
-            for( uint i = 1; i < segment_size ; i++){ // Fill the remaining space of the bloc with 0's
-                col_indices.push_back(0);
-                values.push_back(0);
+    row_indices.resize(base + added);
+    capacity.resize(base + added);
+    col_indices.resize(block_sums[thread_count], 0);
+    values.resize(block_sums[thread_count], 0);
+
+    std::vector<size_t> elements(thread_count, 0); // Elements copied by each thread, explicit zeros included
+    std::vector<std::vector<Index>> zero_rows(thread_count); // Rows holding explicit zeros, marked dirty afterwards
+
+    parallelFor(thread_count, [&](size_t t){ // Copy the rows in order, each thread its own range of rows
+        size_t running = block_sums[t];
+        for (size_t r = added * t / thread_count; r < added * (t + 1) / thread_count; r++){
+            const typename AppendState::RowEntry& entry = state.row(r);
+            Index start = running;
+            typename AppendState::SlotChunk* chunk = nullptr;
+            for (uint64_t pos = entry.pos; pos < entry.pos + entry.size; pos++){
+                if (chunk == nullptr || (pos & MASK) == 0){
+                    chunk = state.slots(pos);
+                }
+                col_indices[running] = chunk->cols[pos & MASK];
+                values[running++] = chunk->vals[pos & MASK];
             }
+            row_indices[base + r].assign(1, std::make_pair(start, entry.size));
+            capacity[base + r] = capacityFor(entry.size);
+            running = start + capacity[base + r];
 
-            end_of_rows = end_of_rows + segment_size; // Update the new end_of_row index, as we added a new bloc of size segment_size
+            elements[t] += entry.size;
+            if (entry.zeros != 0){
+                zero_rows[t].push_back(base + r);
+            }
+        }
+    });
+
+    dirty.resize(base + added, 0);
+    size_t copied = 0;
+    for (size_t t = 0; t < thread_count; t++){
+        copied += elements[t];
+        for (Index r : zero_rows[t]){
+            Index zeros = state.row(r - base).zeros;
+            tombstones += zeros;
+            nnz -= zeros;
+            markDirty(r);
+        }
+    }
+    nnz += copied;
+    padding += block_sums[thread_count] - end_of_rows - copied;
+    if (added != 0){
+        moveInHistogram(0, 1); // Makes sure the bucket of the single segment rows exists
+        segment_histogram[1] += added - 1;
+    }
+
+    end_of_rows = block_sums[thread_count];
+    row_count += added;
+    matrix_size_row = std::max(matrix_size_row, row_count);
+    col_count = std::max(col_count, state.col_count.load());
+    matrix_size_col = std::max(matrix_size_col, col_count);
+    csc_valid = false;
 
-            consistant = false;
+    append_state.reset();
+}
+
+template <typename Index, typename Value>
+void BasicDCSRMatrix<Index, Value>::appendToRow(Index row, Index col, Value value){
+    std::vector<Indices>& segments = row_indices[row];
+    Indices& ind = segments[segments.size() - 1]; // Get right the row start index
+    if ( ind.second < capacity[row] ){ // If we have space left in the last segment, we insert the value
+        Index i = ind.first + ind.second;
+        if ( ind.second != 0 && col_indices[i - 1] >= col ){ // The segment would not be sorted anymore
+            markDirty(row);
         }
+        col_indices [ i ] = col;
+        values[ i ] = value;
 
+        ++ind.second;
+        --padding;
     }
+    else{ // If we have no space left, we allocate a new segment proportional to the size of the row
+        Index row_size = 0;
+        for (const auto& seg : segments){
+            row_size += seg.second;
+        }
+        Index new_capacity = std::max<Index>(segment_size, std::ceil(growth_factor * row_size));
 
-    col_count++;
+        if ( ind.second == 0 ){ // Empty last segment (empty row), replace it : the row stays a single segment
+            ind = std::make_pair(end_of_rows, Index(1));
+            rows_in_order = false;
+        }
+        else{
+            segments.push_back( std::make_pair(end_of_rows, Index(1)) ); // Add a new pair of row start index and element count
+            moveInHistogram(segments.size() - 1, segments.size());
+            markDirty(row);
+        }
 
-    if (col_count > matrix_size_col){ // If the column count is greater than the column capacity of the matrix, increase the column capacity
-        matrix_size_col++;
+        col_indices.push_back(col); // Push the column index and value in the corresponding arrays
+        values.push_back(value);
+        end_of_rows = end_of_rows + new_capacity; // Update the new end_of_row index
+        col_indices.resize(end_of_rows, 0); // Fill the remaining space of the segment with 0's
+        values.resize(end_of_rows, 0);
+
+        capacity[row] = new_capacity;
+        padding += new_capacity - 1; // The previous last segment was full
     }
 
-    return ret_val;
+    if ( value == 0 ){ // An explicit zero is handled as a tombstone
+        ++tombstones;
+        markDirty(row);
+    }
+    else{
+        ++nnz;
+    }
+    ++appended;
 }
 
-double DCSRMatrix::getValue(uint32_t i, uint32_t j) const {
-    double ret_val = 0;
+template <typename Index, typename Value>
+size_t BasicDCSRMatrix<Index, Value>::findEntry(Index i, Index j) const {
+    const std::vector<Indices>& segments = row_indices[i];
 
-    //Not needed, but do we want to run it ?
-    //The current algorithm looks throught all the segments of a row
-    //If we defragment, only need to look throught the first
-    /*if ( !isConsistant() ){
-        defragment();
-    }*/
+    if ( !dirty[i] ){ // Clean row : a single segment sorted by column index, binary search
+        const Index* beg = col_indices.data() + segments[0].first;
+        const Index* end = beg + segments[0].second;
+        const Index* e = std::lower_bound(beg, end, j);
+        if ( e != end && *e == j ){
+            return segments[0].first + (e - beg);
+        }
+    }
+    else{
+        for (const auto& seg : segments){ // For each row start index segment, look for the column index in place
+            const Index* beg = col_indices.data() + seg.first;
+            const Index* end = beg + seg.second;
+            const Index* e = std::find(beg, end, j);
+            if ( e != end ){ // If we found it
+                return seg.first + (e - beg);
+            }
+        }
+    }
+
+    return NOT_FOUND;
+}
+
+template <typename Index, typename Value>
+Value BasicDCSRMatrix<Index, Value>::getValue(Index i, Index j) const {
+    Value ret_val = 0;
 
     if ( i >= matrix_size_row)
         throw std::out_of_range("Wrong row index");
@@ -122,131 +578,664 @@ double DCSRMatrix::getValue(uint32_t i, uint32_t j) const {
     if ( j >= matrix_size_col)
         throw std::out_of_range("Wrong column index");
 
-    bool found = false;
-    uint32_t it = 0;
-    while (!found && it < row_indices[i].size()){ // For each row start index segment
-        if ( row_indices[i][it].second != 0){ // If the segment is not of size 0
-            const auto& beg = std::begin(col_indices) + row_indices[i][it].first; // Get the index of the beginning of the row
-            
-            std::vector<uint32_t> col(beg, beg + row_indices[i][it].second); // REpresent the entire column
-
-            const auto& e = std::find(std::begin(col), std::end(col), j); // Look for the column index
-            if ( e != std::end(col) ){ // If we found it
-                found = true;
-                ret_val = values[ row_indices[i][it].first + std::distance(std::begin(col), e) ]; 
+    if ( i >= row_indices.size() ) // Row reserved at construction but never added, it is empty
+        return ret_val;
+
+    size_t pos = findEntry(i, j);
+    if ( pos != NOT_FOUND ){
+        ret_val = values[pos];
+    }
+
+    return ret_val;
+}
+
+template <typename Index, typename Value>
+void BasicDCSRMatrix<Index, Value>::setValue(Index i, Index j, Value value){
+    if ( i < row_indices.size() ){
+        size_t pos = findEntry(i, j);
+        if ( pos != NOT_FOUND ){ // Existing element (or tombstone), update it in place
+            if ( value == 0 && values[pos] != 0 ){
+                ++tombstones;
+                --nnz;
+                markDirty(i);
             }
+            else if ( value != 0 && values[pos] == 0 ){
+                --tombstones;
+                ++nnz;
+            }
+            if ( csc_valid && (value == 0 || values[pos] == 0) ){ // The element appears in or disappears from the column index
+                csc_valid = false;
+            }
+            else if ( csc_valid ){ // Same position in the column index, patch the value
+                Index* beg = csc_rows.data() + csc_start[j];
+                Index* e = std::lower_bound(beg, csc_rows.data() + csc_start[j + 1], i);
+                csc_values[e - csc_rows.data()] = value;
+            }
+            values[pos] = value;
+            autoDefragment();
+            return;
         }
-        it++;
+    }
+
+    if ( value == 0 ){ // Nothing to store
+        return;
+    }
+
+    PackedVector empty;
+    while ( i >= row_indices.size() ) addRow(empty); // Add empty rows up to row i
+    if ( j >= col_count ){
+        col_count = j + 1;
+        csc_valid = false;
+    }
+    if ( col_count > matrix_size_col ){
+        matrix_size_col = col_count;
+    }
+
+    appendToRow(i, j, value); // Uses the slack of the last segment of the row, or a new segment
+    csc_valid = false;
+    autoDefragment();
+}
+
+template <typename Index, typename Value>
+bool BasicDCSRMatrix<Index, Value>::removeEntry(Index i, Index j){
+    if ( i >= row_indices.size() ){
+        return false;
+    }
+
+    size_t pos = findEntry(i, j);
+    bool ret_val = pos != NOT_FOUND && values[pos] != 0;
+    if ( ret_val ){ // Leave a tombstone, the slot is reclaimed by the next defragment
+        values[pos] = 0;
+        ++tombstones;
+        --nnz;
+        markDirty(i);
+        csc_valid = false;
+        autoDefragment();
     }
 
     return ret_val;
 }
 
-PackedVector DCSRMatrix::getRow(uint32_t index) const {
-    if ( index > row_count){
-        throw std::out_of_range("Wrong row index");
+template <typename Index, typename Value>
+bool BasicDCSRMatrix<Index, Value>::removeRow(Index i){
+    if ( i >= row_indices.size() ){
+        return false;
     }
 
-    PackedVector ret_val;
+    garbage += allocatedSize(i); // The space of the row is left unused until the next defragment
+    padding -= capacity[i] - row_indices[i].back().second;
+    for (const auto& seg : row_indices[i]){
+        for (Index k = seg.first; k < seg.first + seg.second; k++){
+            tombstones -= values[k] == 0 ? 1 : 0;
+            nnz -= values[k] != 0 ? 1 : 0;
+        }
+    }
+    moveInHistogram(row_indices[i].size(), 0);
+
+    row_indices.erase(row_indices.begin() + i);
+    dirty.erase(dirty.begin() + i);
+    capacity.erase(capacity.begin() + i);
+    dirty_rows.erase(std::remove(dirty_rows.begin(), dirty_rows.end(), i), dirty_rows.end());
+    for (auto& r : dirty_rows){ // The following rows are shifted
+        if (r > i){
+            --r;
+        }
+    }
+    consistant = dirty_rows.empty();
+
+    --row_count;
+    --matrix_size_row;
+    csc_valid = false;
 
-    for ( const auto& vec_seg : row_indices[index] ){ // For each row segment
-        uint32_t beg = vec_seg.first;
-        uint32_t size = vec_seg.second;
+    autoDefragment();
+
+    return true;
+}
 
-        for (uint32_t i = beg; i < beg + size; i++){ // Insert each column index/value pair in the ret_val vector
-            ret_val.insert(col_indices[i], values[i]);
+template <typename Index, typename Value>
+bool BasicDCSRMatrix<Index, Value>::removeColumn(Index j){
+    if ( j >= col_count ){
+        return false;
+    }
+
+    size_t thread_count = threadCountFor(col_indices.size(), MIN_NNZ_PER_THREAD);
+    std::vector<size_t> removed_tombstones(thread_count, 0);
+    std::vector<size_t> removed_elements(thread_count, 0);
+    std::vector<size_t> holes(thread_count, 0); // Slots freed in the segments before the last one of each row
+
+    parallelFor(thread_count, [&](size_t t){ // Each row is compacted in place : the elements of column j are dropped, the following columns are shifted
+        size_t nb_rows = row_indices.size();
+        for (size_t i = nb_rows * t / thread_count; i < nb_rows * (t + 1) / thread_count; i++){
+            for (auto& seg : row_indices[i]){
+                Index kept = seg.first;
+                for (Index k = seg.first; k < seg.first + seg.second; k++){
+                    if ( col_indices[k] == j ){
+                        removed_tombstones[t] += values[k] == 0 ? 1 : 0;
+                        removed_elements[t] += values[k] != 0 ? 1 : 0;
+                        continue;
+                    }
+                    col_indices[kept] = col_indices[k] > j ? col_indices[k] - 1 : col_indices[k];
+                    values[kept++] = values[k];
+                }
+                if ( &seg != &row_indices[i].back() ){
+                    holes[t] += seg.second - (kept - seg.first);
+                }
+                seg.second = kept - seg.first;
+            }
         }
+    });
+
+    for (size_t t = 0; t < thread_count; t++){ // The slots freed in the last segments become padding, the others garbage
+        tombstones -= removed_tombstones[t];
+        nnz -= removed_elements[t];
+        padding += removed_tombstones[t] + removed_elements[t] - holes[t];
+        garbage += holes[t];
+    }
+
+    --col_count;
+    --matrix_size_col;
+    csc_valid = false;
+
+    autoDefragment();
+
+    return true;
+}
+
+template <typename Index, typename Value>
+PackedVector BasicDCSRMatrix<Index, Value>::getRow(Index index) const {
+    RowView row = getRowView(index);
+
+    PackedVector ret_val;
+    ret_val.reserve(row.size());
+
+    for ( const auto& e : row ){ // Insert each column index/value pair in the ret_val vector
+        ret_val.insert(e.first, e.second);
     }
 
     return ret_val;
 }
 
-PackedVector DCSRMatrix::getColumn(uint32_t index) const {
-    if ( index > col_count){
+template <typename Index, typename Value>
+typename BasicDCSRMatrix<Index, Value>::RowView BasicDCSRMatrix<Index, Value>::getRowView(Index index) const {
+    if ( index >= row_indices.size()){
         throw std::out_of_range("Wrong row index");
     }
 
+    const std::vector<Indices>& segments = row_indices[index];
+
+    return RowView(segments.data(), segments.size(), col_indices.data(), values.data());
+}
+
+template <typename Index, typename Value>
+PackedVector BasicDCSRMatrix<Index, Value>::getColumn(Index index) const {
+    ColumnView column = getColumnView(index);
+
     PackedVector ret_val;
+    ret_val.reserve(column.size());
+
+    for ( const auto& e : column ){ // Row indices are sorted in the column index, so the insertions are appends
+        ret_val.insert(e.first, e.second);
+    }
+
+    return ret_val;
+}
+
+template <typename Index, typename Value>
+typename BasicDCSRMatrix<Index, Value>::ColumnView BasicDCSRMatrix<Index, Value>::getColumnView(Index index) const {
+    if ( index >= col_count){
+        throw std::out_of_range("Wrong column index");
+    }
+
+    if ( !csc_valid ){
+        buildColumnIndex();
+    }
+
+    Index beg = csc_start[index];
+    Index size = csc_start[index + 1] - beg;
+
+    return ColumnView(Span<Index>(csc_rows.data() + beg, size), Span<Value>(csc_values.data() + beg, size));
+}
+
+template <typename Index, typename Value>
+void BasicDCSRMatrix<Index, Value>::buildColumnIndex() const {
+    csc_start.assign(col_count + 1, 0);
+
+    for ( const auto& row : row_indices ){ // Count the elements of each column
+        for ( const auto& seg : row ){
+            for (Index k = seg.first; k < seg.first + seg.second; k++){
+                csc_start[col_indices[k] + 1] += values[k] != 0 ? 1 : 0; // Tombstones are not in the column index
+            }
+        }
+    }
+    for ( size_t j = 0; j < col_count; j++){ // Prefix sum, csc_start[j] is the start of column j
+        csc_start[j + 1] += csc_start[j];
+    }
 
-    uint32_t i = 0;
-    for ( const auto& row : row_indices ){ // For each row
-        for ( uint32_t k = 0; k < row.size(); k++ ){// For each row start index
-            uint32_t beg = row[k].first;
-            uint32_t size = row[k].second;
+    csc_rows.resize(csc_start[col_count]);
+    csc_values.resize(csc_start[col_count]);
+    std::vector<Index> next(csc_start.begin(), csc_start.end() - 1); // Next free position in each column
 
-            for (uint32_t j = beg; j < beg + size; j++){ // For each column index
-                if (col_indices[j] == index){ // If we find the index we are looking for
-                    ret_val.insert(i, values[j]); // Add the column index/value pair in the ret_val vector
+    for ( Index i = 0; i < row_indices.size(); i++){ // Rows are visited in order, so each column gets sorted row indices
+        for ( const auto& seg : row_indices[i] ){
+            for (Index k = seg.first; k < seg.first + seg.second; k++){
+                if (values[k] == 0){
+                    continue;
                 }
+                Index pos = next[col_indices[k]]++;
+                csc_rows[pos] = i;
+                csc_values[pos] = values[k];
             }
         }
-    
-        i++;
+    }
+
+    csc_valid = true;
+}
+
+template <typename Index, typename Value>
+void BasicDCSRMatrix<Index, Value>::releaseColumnIndex(){
+    std::vector<Index>().swap(csc_start);
+    std::vector<Index>().swap(csc_rows);
+    std::vector<Value>().swap(csc_values);
+    csc_valid = false;
+}
+
+template <typename Index, typename Value>
+std::vector<size_t> BasicDCSRMatrix<Index, Value>::rowPartition(size_t thread_count) const {
+    size_t nb_rows = row_indices.size();
+    std::vector<size_t> ret_val(thread_count + 1, nb_rows);
+    ret_val[0] = 0;
+
+    if (consistant && rows_in_order && nb_rows != 0){ // Each row is a single segment, and the rows are stored in order : split the arrays in equal parts
+        size_t total = end_of_rows;
+        for (size_t t = 1; t < thread_count; t++){
+            size_t target = total * t / thread_count;
+            size_t lo = ret_val[t - 1];
+            size_t hi = nb_rows;
+            while (lo < hi){ // First row starting at or after target
+                size_t mid = lo + (hi - lo) / 2;
+                if (row_indices[mid][0].first < target) lo = mid + 1;
+                else hi = mid;
+            }
+            ret_val[t] = lo;
+        }
+    }
+    else{
+        for (size_t t = 1; t < thread_count; t++){
+            ret_val[t] = nb_rows * t / thread_count;
+        }
     }
 
     return ret_val;
 }
 
-void DCSRMatrix::setSegmentSize(size_t new_size){
+template <typename Index, typename Value>
+void BasicDCSRMatrix<Index, Value>::multiply(const std::vector<Value>& x, std::vector<Value>& y) const {
+    if (x.size() < col_count){
+        throw std::invalid_argument("Vector of size " + std::to_string(x.size()) + " is smaller than the " + std::to_string(col_count) + " columns of the matrix");
+    }
+
+    y.assign(row_indices.size(), 0.0);
+
+    size_t thread_count = threadCountFor(values.size(), MIN_NNZ_PER_THREAD);
+    std::vector<size_t> bounds = rowPartition(thread_count);
+    const Value* xp = x.data();
+
+    parallelFor(thread_count, [&](size_t t){
+        for (size_t i = bounds[t]; i < bounds[t + 1]; i++){
+            Value sum = 0;
+            for (const auto& seg : row_indices[i]){ // A single segment when the matrix is consistant
+                const Index* cols = col_indices.data() + seg.first;
+                const Value* vals = values.data() + seg.first;
+                for (Index k = 0; k < seg.second; k++){
+                    sum += vals[k] * xp[cols[k]];
+                }
+            }
+            y[i] = sum;
+        }
+    });
+}
+
+template <typename Index, typename Value>
+void BasicDCSRMatrix<Index, Value>::transposeMultiply(const std::vector<Value>& u, std::vector<Value>& y) const {
+    if (u.size() < row_indices.size()){
+        throw std::invalid_argument("Vector of size " + std::to_string(u.size()) + " is smaller than the " + std::to_string(row_indices.size()) + " rows of the matrix");
+    }
+
+    y.assign(col_count, 0.0);
+
+    size_t thread_count = threadCountFor(values.size(), MIN_NNZ_PER_THREAD);
+    std::vector<size_t> bounds = rowPartition(thread_count);
+    std::vector<std::vector<Value>> partial(thread_count - 1); // Accumulators of the threads other than the calling one, which uses y
+
+    parallelFor(thread_count, [&](size_t t){
+        Value* acc = y.data();
+        if (t != 0){
+            partial[t - 1].assign(col_count, 0.0); // Allocated by the thread that uses it
+            acc = partial[t - 1].data();
+        }
+        for (size_t i = bounds[t]; i < bounds[t + 1]; i++){
+            Value ui = u[i];
+            if (ui == 0){
+                continue;
+            }
+            for (const auto& seg : row_indices[i]){
+                const Index* cols = col_indices.data() + seg.first;
+                const Value* vals = values.data() + seg.first;
+                for (Index k = 0; k < seg.second; k++){
+                    acc[cols[k]] += vals[k] * ui;
+                }
+            }
+        }
+    });
+
+    if (thread_count > 1){
+        parallelFor(thread_count, [&](size_t t){ // Sum the accumulators, each thread on its own range of columns
+            size_t beg = col_count * t / thread_count;
+            size_t end = col_count * (t + 1) / thread_count;
+            for (const auto& acc : partial){
+                for (size_t j = beg; j < end; j++){
+                    y[j] += acc[j];
+                }
+            }
+        });
+    }
+}
+
+template <typename Index, typename Value>
+void BasicDCSRMatrix<Index, Value>::setSegmentSize(size_t new_size){
+    if (new_size == 0){
+        throw std::invalid_argument("Segment size must be greater than 0");
+    }
     segment_size = new_size;
-    defragment();
+    defragment(true);
+}
+
+template <typename Index, typename Value>
+void BasicDCSRMatrix<Index, Value>::setGrowthFactor(double factor){
+    if (factor <= 0){
+        throw std::invalid_argument("Growth factor must be greater than 0, got " + std::to_string(factor));
+    }
+    growth_factor = factor;
+}
+
+template <typename Index, typename Value>
+Index BasicDCSRMatrix<Index, Value>::capacityFor(Index size) const {
+    return size + std::min<Index>(row_slack, std::max<Index>(size, segment_size)); // The slack of a row is at most its size, so a few rows that get many appends do not pad every row
+}
+
+template <typename Index, typename Value>
+Index BasicDCSRMatrix<Index, Value>::allocatedSize(Index row) const {
+    const std::vector<Indices>& segments = row_indices[row];
+    Index ret_val = capacity[row];
+    for (size_t k = 0; k + 1 < segments.size(); k++){ // The segments before the last one were full when the next one was allocated
+        ret_val += segments[k].second;
+    }
+    return ret_val;
+}
+
+template <typename Index, typename Value>
+void BasicDCSRMatrix<Index, Value>::markDirty(Index row){
+    if (!dirty[row]){
+        dirty[row] = 1;
+        dirty_rows.push_back(row);
+    }
+    consistant = false;
 }
 
-void DCSRMatrix::defragment(){
+template <typename Index, typename Value>
+void BasicDCSRMatrix<Index, Value>::moveInHistogram(size_t from, size_t to){
+    if (from != 0){
+        --segment_histogram[from];
+    }
+    if (to != 0){
+        if (to >= segment_histogram.size()){
+            segment_histogram.resize(to + 1, 0);
+        }
+        ++segment_histogram[to];
+    }
+}
 
-    std::vector<std::vector<Indices>> new_row_indices;
-    std::vector<uint32_t> new_col_indices;
-    std::vector<double> new_values;
+template <typename Index, typename Value>
+double BasicDCSRMatrix<Index, Value>::fragmentation() const {
+    double ret_val = 0;
+    if (!col_indices.empty()){
+        ret_val = double(garbage + tombstones) / col_indices.size();
+    }
+    if (!row_indices.empty()){
+        ret_val = std::max(ret_val, double(dirty_rows.size()) / row_indices.size());
+    }
+    return ret_val;
+}
 
-    uint32_t index_beg = 0;
+template <typename Index, typename Value>
+void BasicDCSRMatrix<Index, Value>::autoDefragment(){
+    if (auto_defragment <= 0){
+        return;
+    }
+    if (!col_indices.empty() && double(garbage + tombstones) / col_indices.size() > auto_defragment){ // Only a full defragment reclaims unused space
+        defragment(true);
+    }
+    else if (!row_indices.empty() && double(dirty_rows.size()) / row_indices.size() > auto_defragment){
+        defragment();
+    }
+}
 
-    for (uint32_t i = 0; i < row_indices.size(); i++){ // For each row
-        uint32_t size = 0;
+template <typename Index, typename Value>
+void BasicDCSRMatrix<Index, Value>::setAutoDefragment(double threshold){
+    if (threshold < 0){
+        throw std::invalid_argument("Auto defragment threshold must not be negative, got " + std::to_string(threshold));
+    }
+    auto_defragment = threshold;
+    autoDefragment();
+}
 
-        std::map<uint32_t, double> col_val_temp; // Temporary map to hold the column indexes and the vlaues associated
-        for (const auto& vec_seg : row_indices[i]){ // For each row start segment
-            uint32_t s_index = vec_seg.first;
-            uint32_t seg_size = vec_seg.second;
+template <typename Index, typename Value>
+typename BasicDCSRMatrix<Index, Value>::Stats BasicDCSRMatrix<Index, Value>::stats() const {
+    Stats ret_val;
+    ret_val.rows = row_indices.size();
+    ret_val.nnz = nnz;
+    ret_val.tombstones = tombstones;
+    ret_val.allocated_slots = col_indices.size();
+    ret_val.padding = padding;
+    ret_val.garbage = garbage;
+    ret_val.padding_ratio = col_indices.empty() ? 0 : double(col_indices.size() - nnz) / col_indices.size();
+    ret_val.fragmentation = fragmentation();
+    ret_val.fragmented_rows = dirty_rows.size();
+    ret_val.segment_histogram = segment_histogram;
+
+    size_t segments = 0;
+    for (size_t k = 0; k < segment_histogram.size(); k++){
+        segments += k * segment_histogram[k];
+    }
+    ret_val.col_indices_bytes = col_indices.capacity() * sizeof(Index);
+    ret_val.values_bytes = values.capacity() * sizeof(Value);
+    ret_val.row_indices_bytes = row_indices.capacity() * sizeof(std::vector<Indices>) + segments * sizeof(Indices)
+                              + capacity.capacity() * sizeof(Index) + dirty.capacity() * sizeof(uint8_t) + dirty_rows.capacity() * sizeof(Index);
+    ret_val.column_index_bytes = (csc_start.capacity() + csc_rows.capacity()) * sizeof(Index) + csc_values.capacity() * sizeof(Value);
 
-            size += seg_size;
+    ret_val.defragment_count = defragment_count;
+    ret_val.last_defragment = last_defragment;
+    ret_val.last_defragment_seconds = last_defragment_seconds;
 
-            for (uint32_t j = 0; j < seg_size ; j++){ // For each column
-                uint32_t col_value = col_indices[s_index + j];
-                double value = values[s_index+ j];
-                col_val_temp.insert(std::make_pair(col_value, value) ); // Add the column index and value associated to the col_val_temp map
+    return ret_val;
+}
+
+template <typename Index, typename Value>
+Index BasicDCSRMatrix<Index, Value>::gatherRow(Index row, std::vector<std::pair<Index, Value>>& buffer) const {
+    size_t first = buffer.size();
+    bool sorted = true;
+    for (const auto& seg : row_indices[row]){
+        for (Index k = seg.first; k < seg.first + seg.second; k++){
+            if (values[k] == 0){ // Tombstone
+                continue;
             }
+            sorted = sorted && (buffer.size() == first || buffer.back().first < col_indices[k]);
+            buffer.emplace_back(col_indices[k], values[k]);
         }
+    }
 
-        uint32_t total_bloc_size = size % segment_size == 0 ? size : std::floor(size / segment_size)*segment_size + segment_size; // Total number of values in the column + some to fill the last "bloc"
+    if (!sorted){ // Sort by column index, and keep the first value of a duplicate column
+        std::stable_sort(std::begin(buffer) + first, std::end(buffer), [](const std::pair<Index, Value>& a, const std::pair<Index, Value>& b){
+            return a.first < b.first;
+        });
+        buffer.erase(std::unique(std::begin(buffer) + first, std::end(buffer), [](const std::pair<Index, Value>& a, const std::pair<Index, Value>& b){
+            return a.first == b.first;
+        }), std::end(buffer));
+    }
 
-        for (const auto& e : col_val_temp){ // Add the columns indexes and value to the new columns and values vector
-            new_col_indices.push_back(e.first);
-            new_values.push_back(e.second);
-        }
-        for (uint32_t j = size; j < total_bloc_size; j++){ // Fill the last "bloc"
-            new_col_indices.push_back(0);
-            new_values.push_back(0);
+    return buffer.size() - first;
+}
+
+template <typename Index, typename Value>
+void BasicDCSRMatrix<Index, Value>::defragment(bool full){
+    size_t nb_rows = row_indices.size();
+    row_slack = nb_rows == 0 ? 0 : (appended + nb_rows - 1) / nb_rows; // Rows moved or rebuilt get as much slack as the appends per row seen since the last defragment
+    appended = 0;
+
+    size_t relocated = 0; // Space the dirty rows will leave behind if they are moved
+    for (Index i : dirty_rows){
+        relocated += allocatedSize(i);
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    if (full || 2 * (garbage + relocated) > col_indices.size() || 4 * dirty_rows.size() > nb_rows){
+        rebuild();
+    }
+    else if (!dirty_rows.empty()){
+        relocateDirtyRows();
+    }
+    else{ // Nothing to do
+        return;
+    }
+
+    last_defragment_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    last_defragment = std::chrono::system_clock::now();
+    ++defragment_count;
+}
+
+template <typename Index, typename Value>
+void BasicDCSRMatrix<Index, Value>::relocateDirtyRows(){
+    std::vector<std::pair<Index, Value>> buffer;
+
+    for (Index i : dirty_rows){ // Move each fragmented row, as a single segment, at the end of the arrays
+        garbage += allocatedSize(i);
+        padding -= capacity[i] - row_indices[i].back().second;
+        moveInHistogram(row_indices[i].size(), 1);
+
+        buffer.clear();
+        Index size = gatherRow(i, buffer);
+        Index start = col_indices.size();
+        Index total_bloc_size = capacityFor(size);
+
+        for (const auto& e : buffer){
+            col_indices.push_back(e.first);
+            values.push_back(e.second);
         }
-        
-        std::vector<Indices> vec_seg; 
-        vec_seg.reserve(index_segment_size);
-        vec_seg.push_back( std::make_pair(index_beg, size) );
+        col_indices.resize(start + total_bloc_size, 0); // Slack of the row
+        values.resize(start + total_bloc_size, 0);
 
-        new_row_indices.push_back( vec_seg ); // Add the defragmented row indices to the the row indices vector
+        row_indices[i].assign(1, std::make_pair(start, size));
+        capacity[i] = total_bloc_size;
+        padding += total_bloc_size - size;
+        dirty[i] = 0;
+    }
 
-        index_beg += total_bloc_size;
+    end_of_rows = col_indices.size();
+    dirty_rows.clear();
+    tombstones = 0; // Every row holding a tombstone is dirty, so they were all dropped
+    rows_in_order = false; // The moved rows are now after rows with a greater index
+    consistant = true;
+}
+
+template <typename Index, typename Value>
+void BasicDCSRMatrix<Index, Value>::rebuild(){
+    size_t nb_rows = row_indices.size();
+    size_t thread_count = threadCountFor(col_indices.size(), MIN_NNZ_PER_THREAD);
+    std::vector<Index> offsets(nb_rows + 1, 0); // Start of each row in the new arrays
+    std::vector<Index> sizes(nb_rows, 0); // Number of elements of each row
+    std::vector<size_t> block_sums(thread_count + 1, 0); // Total size of the rows of each thread
+    std::vector<std::vector<std::pair<Index, Value>>> gathered(thread_count); // Dirty rows of each block, sorted and merged by the first pass, one after the other
+
+    parallelFor(thread_count, [&](size_t t){ // Size of each row, and of each block of rows
+        size_t beg = nb_rows * t / thread_count;
+        size_t end = nb_rows * (t + 1) / thread_count;
+        for (size_t i = beg; i < end; i++){
+            Index size = 0;
+            if (dirty[i]){ // Fragmented rows may hold unsorted or duplicate columns, gather the ones that will be kept once
+                size = gatherRow(i, gathered[t]);
+            }
+            else{
+                size = row_indices[i][0].second;
+            }
+            sizes[i] = size;
+            block_sums[t + 1] += capacityFor(size);
+        }
+    });
+
+    for (size_t t = 0; t < thread_count; t++){ // Start of each block of rows
+        block_sums[t + 1] += block_sums[t];
     }
 
-    std::swap(new_row_indices, row_indices); // Swap the old vectors with the new, defragmented ones
-    std::swap(new_col_indices, col_indices);
+    parallelFor(thread_count, [&](size_t t){ // Prefix sum inside each block
+        size_t beg = nb_rows * t / thread_count;
+        size_t end = nb_rows * (t + 1) / thread_count;
+        size_t running = block_sums[t];
+        for (size_t i = beg; i < end; i++){
+            offsets[i] = running;
+            running += capacityFor(sizes[i]);
+        }
+    });
+    offsets[nb_rows] = block_sums[thread_count];
+
+    std::vector<Index> new_col_indices(offsets[nb_rows], 0);
+    std::vector<Value> new_values(offsets[nb_rows], 0);
+
+    parallelFor(thread_count, [&](size_t t){ // Copy the rows, each thread writes to its own part of the new arrays
+        size_t beg = nb_rows * t / thread_count;
+        size_t end = nb_rows * (t + 1) / thread_count;
+        const std::pair<Index, Value>* next = gathered[t].data(); // The block reads its dirty rows back in the order of the first pass
+        for (size_t i = beg; i < end; i++){
+            Index pos = offsets[i];
+            if (dirty[i]){
+                for (Index k = 0; k < sizes[i]; k++, ++next){
+                    new_col_indices[pos] = next->first;
+                    new_values[pos++] = next->second;
+                }
+            }
+            else{ // Single sorted segment, plain copy
+                const Indices& seg = row_indices[i][0];
+                std::copy(col_indices.begin() + seg.first, col_indices.begin() + seg.first + seg.second, new_col_indices.begin() + pos);
+                std::copy(values.begin() + seg.first, values.begin() + seg.first + seg.second, new_values.begin() + pos);
+            }
+            row_indices[i].assign(1, std::make_pair(offsets[i], sizes[i]));
+            capacity[i] = capacityFor(sizes[i]);
+            dirty[i] = 0;
+        }
+        std::vector<std::pair<Index, Value>>().swap(gathered[t]);
+    });
+
+    std::swap(new_col_indices, col_indices); // Swap the old vectors with the new, defragmented ones
     std::swap(new_values, values);
 
+    end_of_rows = col_indices.size();
+    dirty_rows.clear();
+    garbage = 0;
+    tombstones = 0;
+    nnz = 0;
+    for (Index size : sizes){
+        nnz += size;
+    }
+    padding = col_indices.size() - nnz;
+    segment_histogram.assign(2, 0);
+    segment_histogram[1] = nb_rows;
+    rows_in_order = true;
     consistant = true;
 }
 
-void DCSRMatrix::display(bool do_defrag){
+template <typename Index, typename Value>
+void BasicDCSRMatrix<Index, Value>::display(bool do_defrag){
     if (do_defrag)
-        defragment();
+        defragment(true);
 
     std::cout << "Row indices : \n";
     auto max_v = *std::max_element( std::begin(row_indices), std::end(row_indices), 
@@ -254,8 +1243,8 @@ void DCSRMatrix::display(bool do_defrag){
             return v1.size() < v2.size();        
         } 
     );
-    uint32_t max = max_v.size();
-    for (uint32_t i = 0; i < max; i++){
+    Index max = max_v.size();
+    for (Index i = 0; i < max; i++){
         for (const auto& e : row_indices){
             if (i < e.size()){
                 std::cout << e[i].first << "->" << e[i].second << " ";
@@ -279,7 +1268,7 @@ void DCSRMatrix::display(bool do_defrag){
     }
     std::cout << "\n\n";
 
-    for ( uint32_t i = 0; i < row_count; i++){
+    for ( Index i = 0; i < row_count; i++){
 
         for(uint j = 0; j < matrix_size_col; j++){
             std::cout << getValue(i, j) << " ";
@@ -288,8 +1277,8 @@ void DCSRMatrix::display(bool do_defrag){
         
     }
 
-    for (uint32_t i = row_count; i < matrix_size_row; i++){
-        for (uint32_t j = 0; j < matrix_size_col; j++){
+    for (Index i = row_count; i < matrix_size_row; i++){
+        for (Index j = 0; j < matrix_size_col; j++){
             std::cout << "0 ";
         }
         std::cout << "\n";
@@ -297,4 +1286,8 @@ void DCSRMatrix::display(bool do_defrag){
 
 }
 
-}
\ No newline at end of file
+template class BasicDCSRMatrix<uint32_t, double>;
+template class BasicDCSRMatrix<uint64_t, double>;
+template class BasicDCSRMatrix<uint32_t, float>;
+
+}
@@ -4,75 +4,341 @@
 #include <vector>
 #include <utility>
 #include <cstdint>
+#include <chrono>
+#include <memory>
 
 #include "PackedVector.hpp"
+#include "Span.hpp"
 
 namespace Osi2 {
 
-typedef std::pair<uint32_t, uint32_t> Indices;
+typedef std::pair<uint32_t, uint32_t> Indices; ///< (start, element count) of a segment of a DCSRMatrix row
 
 
 /*! \brief Implementation of a DCSR matrix
 
     Works on the principle of lazy updates, and needs to be defragmented before some operations
 
+    Each row gets some slack after its elements, sized from the appends observed between two defragments, so that adding columns
+    writes in place. When the slack of a row is used up, a new segment proportional to the row size is allocated (geometric growth),
+    so a row that keeps growing is made of a logarithmic number of segments.
+
     From a paper of James King, Thomas Gilray, Robert M. Kirby and Matthew Might (https://thomas.gilray.org/pdf/dynamic-csr-journal.pdf)
+
+    Index is the type of the column indices and of the positions in the arrays, so it also bounds the number of stored elements
+    (4G with uint32_t). Value is the type of the coefficients. The member functions are defined in DCSRMatrix.cpp and instantiated
+    there for <uint32_t, double> (DCSRMatrix), <uint64_t, double> and <uint32_t, float>.
  */
-class DCSRMatrix {
+template <typename Index, typename Value>
+class BasicDCSRMatrix {
     public:
+        typedef std::pair<Index, Index> Indices; ///< (start, element count) of a segment of a row
+
+        /*! \brief Read-only view over a row of the matrix
+
+            A row is made of one or more segments of the column indices and values arrays. The view walks through them without copying anything.
+            It is only valid as long as the matrix is not modified.
+         */
+        class RowView {
+            public:
+                /// Iterator over the (column index, value) pairs of the row, segment after segment
+                class const_iterator {
+                    public:
+                        typedef std::forward_iterator_tag iterator_category;
+                        typedef std::pair<Index, Value> value_type;
+                        typedef std::ptrdiff_t difference_type;
+                        typedef const value_type* pointer;
+                        typedef value_type reference;
+
+                        /// Holds a pair so that it->first and it->second work on a value built on the fly
+                        struct Arrow {
+                            value_type pair;
+                            const value_type* operator->() const { return &pair; }
+                        };
+
+                        const_iterator(const RowView* row, size_t segment) : row(row), segment(segment), pos(0) { skipEmpty(); }
+
+                        value_type operator*() const {
+                            Index k = row->segments[segment].first + pos;
+                            return value_type(row->col_indices[k], row->values[k]);
+                        }
+                        Arrow operator->() const { return Arrow{**this}; }
+
+                        const_iterator& operator++() { ++pos; skipEmpty(); return *this; }
+                        const_iterator operator++(int) { const_iterator ret_val(*this); ++(*this); return ret_val; }
+                        bool operator==(const const_iterator& other) const { return segment == other.segment && pos == other.pos; }
+                        bool operator!=(const const_iterator& other) const { return !(*this == other); }
+
+                    private:
+                        /// Move to the next segment when the current one is done
+                        void skipEmpty(){
+                            while (segment < row->segment_count && pos == row->segments[segment].second){
+                                ++segment;
+                                pos = 0;
+                            }
+                        }
+
+                        const RowView* row; ///< Row being walked through
+                        size_t segment; ///< Current segment
+                        Index pos; ///< Position inside the current segment
+                };
+
+                RowView(const Indices* segments, size_t segment_count, const Index* col_indices, const Value* values)
+                    : segments(segments), segment_count(segment_count), col_indices(col_indices), values(values), count(0) {
+                    for (size_t k = 0; k < segment_count; k++){
+                        count += segments[k].second;
+                    }
+                }
+
+                /// Get the number of elements in the row
+                size_t size() const { return count; }
+
+                /// Check if the row has no element
+                bool empty() const { return count == 0; }
+
+                /// Get the number of segments the row is made of (1 if the matrix is consistant)
+                size_t segmentCount() const { return segment_count; }
+
+                /// Get the column indices of a segment
+                Span<Index> segmentIndices(size_t k) const { return Span<Index>(col_indices + segments[k].first, segments[k].second); }
+
+                /// Get the values of a segment
+                Span<Value> segmentValues(size_t k) const { return Span<Value>(values + segments[k].first, segments[k].second); }
+
+                const_iterator begin() const { return const_iterator(this, 0); }
+                const_iterator end() const { return const_iterator(this, segment_count); }
+
+            private:
+                const Indices* segments; ///< (start, element count) of each segment of the row
+                size_t segment_count; ///< Number of segments
+                const Index* col_indices; ///< Column indices array of the matrix
+                const Value* values; ///< Values array of the matrix
+                size_t count; ///< Number of elements in the row
+        };
+
+        /*! \brief Read-only view over a column of the matrix
+
+            Reads the (row index, value) pairs of the column in place from the column index, sorted by row index.
+            It is only valid as long as the matrix is not modified.
+         */
+        class ColumnView {
+            public:
+                /// Iterator over the (row index, value) pairs of the column
+                class const_iterator {
+                    public:
+                        typedef std::forward_iterator_tag iterator_category;
+                        typedef std::pair<Index, Value> value_type;
+                        typedef std::ptrdiff_t difference_type;
+                        typedef const value_type* pointer;
+                        typedef value_type reference;
+
+                        /// Holds a pair so that it->first and it->second work on a value built on the fly
+                        struct Arrow {
+                            value_type pair;
+                            const value_type* operator->() const { return &pair; }
+                        };
+
+                        const_iterator(const Index* rows, const Value* values) : rows(rows), values(values) {}
+
+                        value_type operator*() const { return value_type(*rows, *values); }
+                        Arrow operator->() const { return Arrow{**this}; }
+
+                        const_iterator& operator++() { ++rows; ++values; return *this; }
+                        const_iterator operator++(int) { const_iterator ret_val(*this); ++(*this); return ret_val; }
+                        bool operator==(const const_iterator& other) const { return rows == other.rows; }
+                        bool operator!=(const const_iterator& other) const { return rows != other.rows; }
+
+                    private:
+                        const Index* rows; ///< Current row index
+                        const Value* values; ///< Current value
+                };
+
+                ColumnView(Span<Index> rows, Span<Value> values) : rows(rows), values(values) {}
+
+                /// Get the number of elements in the column
+                size_t size() const { return rows.size(); }
+
+                /// Check if the column has no element
+                bool empty() const { return rows.empty(); }
+
+                /// Get the k-th (row index, value) pair of the column
+                std::pair<Index, Value> operator[](size_t k) const { return std::pair<Index, Value>(rows[k], values[k]); }
+
+                /// Get the row indices of the column
+                Span<Index> rowIndices() const { return rows; }
+
+                /// Get the values of the column
+                Span<Value> columnValues() const { return values; }
+
+                const_iterator begin() const { return const_iterator(rows.begin(), values.begin()); }
+                const_iterator end() const { return const_iterator(rows.end(), values.end()); }
+
+            private:
+                Span<Index> rows; ///< Row indices of the elements
+                Span<Value> values; ///< Values of the elements
+        };
+
+        /// Fill, padding and fragmentation figures of the matrix, returned by stats()
+        struct Stats {
+            size_t rows; ///< Number of rows
+            size_t nnz; ///< Number of stored elements, tombstones excluded
+            size_t tombstones; ///< Number of removed elements still stored as zeros
+            size_t allocated_slots; ///< Size of the column indices and values arrays
+            size_t padding; ///< Slots left at the end of the rows for future appends
+            size_t garbage; ///< Slots left unused by the rows moved by defragment or removed
+            double padding_ratio; ///< Fraction of the allocated slots that do not hold an element
+            double fragmentation; ///< Fraction of the slots a defragment would reclaim, or of the rows waiting for one, whichever is greater
+            size_t fragmented_rows; ///< Number of rows waiting for a defragment (several segments, unsorted or with tombstones)
+            std::vector<size_t> segment_histogram; ///< segment_histogram[k] is the number of rows made of k segments
+            size_t col_indices_bytes; ///< Memory of the column indices array
+            size_t values_bytes; ///< Memory of the values array
+            size_t row_indices_bytes; ///< Memory of the segments of the rows and of the per row data
+            size_t column_index_bytes; ///< Memory of the column index, 0 if it is not built
+            size_t defragment_count; ///< Number of defragments that moved or rebuilt rows
+            std::chrono::system_clock::time_point last_defragment; ///< End of the last defragment (epoch if there was none)
+            double last_defragment_seconds; ///< Duration of the last defragment
+        };
+
         /// \name Constructors
         //{@
 
         /// Default Constructor
-        DCSRMatrix();
+        BasicDCSRMatrix();
+
+        /// Constructs a matrix initialized with a given number of rows and columns
+        BasicDCSRMatrix(size_t nb_rows, size_t nb_cols);
+
+        /*! \brief Build a consistant matrix from (row, column, value) triplets given in any order
 
-        /// Constructs a DCSRMatrix initialized with a given number of rows and columns
-        DCSRMatrix(size_t nb_rows, size_t nb_cols);
+            The triplets are sorted in parallel (radix sort on the row/column key), the values of duplicate coordinates are summed,
+            and the rows are written directly in their final place. The matrix has at least nb_rows rows and nb_cols columns.
+            Throws std::invalid_argument if a (row, column) key does not fit on 64 bits.
+         */
+        static BasicDCSRMatrix fromTriplets(const std::vector<Index>& rows, const std::vector<Index>& cols, const std::vector<Value>& vals,
+                                       size_t nb_rows = 0, size_t nb_cols = 0);
         //@}
 
         /// \name Editing functions
         //{@
 
-        /// Append a row, described by a PackedVector
+        /// Append a row, described by a PackedVector (its values are converted to Value)
         bool addRow(const PackedVector& v);
 
         /// Append a Column, described by a PackedVector
         bool addColumn(const PackedVector& v);
+
+        /*! \brief Start the concurrent append mode : concurrentAddRow can then be called from several threads at once
+
+            Until seal(), concurrentAddRow is the only function that may be called on the matrix, and the matrix must not be copied.
+         */
+        void beginConcurrentAppend();
+
+        /*! \brief Append a row, described by a PackedVector, from any thread. Returns the index the row will have
+
+            The row index and the space of the elements are reserved with atomic increments, and the elements are written into chunks
+            allocated on demand, so the threads never wait for each other. The rows are numbered in the order of their reservation.
+            If the allocation of a chunk throws, the exception is passed on and the next seal() fails.
+         */
+        Index concurrentAddRow(const PackedVector& v);
+
+        /// End the concurrent append mode : the appended rows are copied in parallel at the end of the arrays, in row order. Call it once every thread is done.
+        /// If a concurrentAddRow threw, no row is appended and std::runtime_error is thrown, the matrix keeps the rows it had before beginConcurrentAppend
+        void seal();
+
+        /// Set the value at coordinate (i,j). Updates the element in place if it exists, otherwise uses the slack of the row. Rows and columns are added if needed
+        void setValue(Index i, Index j, Value value);
+
+        /// Remove the element at coordinate (i,j). Leaves a tombstone (a stored zero) that is reclaimed by the next defragment. Returns false if there was no element
+        bool removeEntry(Index i, Index j);
+
+        /// Remove a row, the following rows are shifted up. Its space is reclaimed by the next full defragment
+        bool removeRow(Index i);
+
+        /// Remove a column, the following columns are shifted left. Compacts every row in place, in O(nnz)
+        bool removeColumn(Index j);
         //@}
 
-        /// Defragment the matrix (no need to call it by hand)
-        void defragment();
+        /*! \brief Defragment the matrix (no need to call it by hand)
+
+            Only the rows fragmented by addColumn are compacted : each one is moved as a single segment at the end of the arrays.
+            When the moved rows leave too much unused space behind, or when full is set, every row is rebuilt in parallel instead.
+         */
+        void defragment(bool full = false);
+
+        /// Free the memory of the column index. It is built again on the next column access
+        void releaseColumnIndex();
+
+        /// \name Numeric kernels
+        //{@
+
+        /// Compute y = A x. x must have at least getColumnCount() elements, y is resized to getRowCount(). Rows are split between threads
+        void multiply(const std::vector<Value>& x, std::vector<Value>& y) const;
+
+        /// Compute y = A^T u. u must have at least getRowCount() elements, y is resized to getColumnCount(). Each thread accumulates its rows in its own vector
+        void transposeMultiply(const std::vector<Value>& u, std::vector<Value>& y) const;
+        //@}
 
         /// \name Getters
         //{@
 
-        /// Get the value at coordinate (i,j) (starting at (0,0))
-        double getValue(uint32_t i, uint32_t j) const;
+        /// Get the value at coordinate (i,j) (starting at (0,0)). Binary search on defragmented rows, search of each segment otherwise. Never allocates
+        Value getValue(Index i, Index j) const;
 
-        /// Get an entire row
-        PackedVector getRow(uint32_t index) const;
+        /// Get an entire row, as a copy with uint32_t indices and double values
+        PackedVector getRow(Index index) const;
 
-        /// Get an entire column
-        PackedVector getColumn(uint32_t index) const;
+        /// Get a view over an entire row, without copying it
+        RowView getRowView(Index index) const;
+
+        /// Export the elements as (row, column, value) triplets, row by row
+        void toTriplets(std::vector<Index>& rows, std::vector<Index>& cols, std::vector<Value>& vals) const;
+
+        /// Get an entire column, as a copy with uint32_t indices and double values. Builds the column index on the first call
+        PackedVector getColumn(Index index) const;
+
+        /// Get a view over an entire column (row index, value), read from the column index in O(column size). Builds the column index on the first call
+        ColumnView getColumnView(Index index) const;
 
         /// Check if the matrix needs to be defragmented before use
         bool isConsistant() const { return consistant; }
 
-        /// Get the size of the "chunks" of numbers we are using
+        /// Get the minimum size of a segment allocated when a row is full
         size_t getSegmentSize() const { return segment_size; }
 
+        /// Get the growth factor of the rows : a full row gets a new segment of growth factor times its size
+        double getGrowthFactor() const { return growth_factor; }
+
+        /// Get the number of slots allocated at the end of the rows for future appends, and not holding an element yet
+        size_t getPaddingWaste() const { return padding; }
+
+        /// Get the fill, padding and fragmentation figures of the matrix. Read from counters kept up to date by the edits, in O(number of segments per row)
+        Stats stats() const;
+
+        /// Get the fragmentation threshold over which the matrix defragments itself after an edit (0 if disabled)
+        double getAutoDefragment() const { return auto_defragment; }
+
         /// Get the number of rows
-        uint32_t getRowCount() const { return row_count; }
+        Index getRowCount() const { return row_count; }
 
         /// Get the number of columns
-        uint32_t getColumnCount() const { return col_count; }
+        Index getColumnCount() const { return col_count; }
         //@}
 
         /// \name Setters
         //{@  
 
-        /// Set the size of the "chunks" of numbers we are using
+        /// Set the minimum size of a segment allocated when a row is full
         void setSegmentSize(size_t new_size);
+
+        /// Set the growth factor of the rows (greater than 0). 1 doubles the space of a row each time it is full
+        void setGrowthFactor(double factor);
+
+        /*! \brief Defragment the matrix after an edit when its fragmentation (see Stats) goes over threshold
+
+            Checked in constant time by addColumn, setValue and the remove functions. The views are invalidated when it happens.
+            0 (the default) disables it, the matrix is then only defragmented by hand or when it needs to be.
+         */
+        void setAutoDefragment(double threshold);
         //@}
 
         /// For debugging purpose
@@ -80,21 +346,95 @@ class DCSRMatrix {
         
     private:
         std::vector<std::vector<Indices>> row_indices;  ///< Vector of vector representing rows indices and segments of data related to this row
-        std::vector<uint32_t> col_indices; ///< Vector of column indices
-        std::vector<double> values; ///< Vector of values
+        std::vector<Index> col_indices; ///< Vector of column indices
+        std::vector<Value> values; ///< Vector of values
 
         size_t matrix_size_row; ///< Height of the matrix (for initialization)
         size_t matrix_size_col; ///< Width of the matrix (for initialization)
 
         size_t row_count = 0; ///< Number of actual rows in the matrix
         size_t col_count = 0; ///< Number of actual columns in the matrix
-        size_t segment_size = 5; ///< Size of the "chunks" of numbers
-        size_t index_segment_size = 3; ///< Initial number of index segments
-        bool consistant = true; ///< Contains the current consistancy state
+        size_t segment_size = 5; ///< Minimum size of a segment allocated when a row is full
+        double growth_factor = 1.0; ///< A full row gets a new segment of growth_factor times its size
+        std::vector<Index> capacity; ///< Number of slots of the last segment of each row, elements included
+        size_t appended = 0; ///< Number of elements appended to existing rows since the last defragment
+        Index row_slack = 0; ///< Slack given to the rows when they are allocated : appends per row observed before the last defragment
 
-        uint32_t end_of_rows = 0; ///< To take into account empty spaces at the end of rows (TODO: is it usefull of just use values vector length ?)
+        size_t nnz = 0; ///< Number of stored elements, tombstones excluded
+        size_t padding = 0; ///< Free slots at the end of the last segment of the rows
+        std::vector<size_t> segment_histogram; ///< Number of rows made of k segments, at index k
+        double auto_defragment = 0; ///< Fragmentation over which the edits defragment the matrix, 0 to disable
+        size_t defragment_count = 0; ///< Number of defragments that moved or rebuilt rows
+        std::chrono::system_clock::time_point last_defragment; ///< End of the last defragment
+        double last_defragment_seconds = 0; ///< Duration of the last defragment
+        bool consistant = true; ///< Contains the current consistancy state (no dirty row)
+        std::vector<uint8_t> dirty; ///< 1 for each row that needs compaction (several segments, unsorted or tombstones), 0 for rows made of a single sorted segment without tombstone
+        std::vector<Index> dirty_rows; ///< Indices of the dirty rows, so that defragment only visits them
+        size_t garbage = 0; ///< Space of the arrays left unused by the rows moved by defragment or removed
+        size_t tombstones = 0; ///< Number of removed elements still stored as zeros
+        bool rows_in_order = true; ///< True if the rows are stored in the arrays in increasing row index
+
+        Index end_of_rows = 0; ///< To take into account empty spaces at the end of rows (TODO: is it usefull of just use values vector length ?)
+
+        /// Build the column index (CSC copy of the matrix) from the rows
+        void buildColumnIndex() const;
+
+        /// Get the capacity given to a row of a given size when it is allocated : its size plus the slack expected from the append rate
+        Index capacityFor(Index size) const;
+
+        /// Get the space used by a row in the arrays, slack of the last segment included
+        Index allocatedSize(Index row) const;
+
+        /// Append an element at the end of a row : in the slack of its last segment, or in a new segment
+        void appendToRow(Index row, Index col, Value value);
+
+        /// Get the position of the element (i,j) in the arrays, or NOT_FOUND
+        size_t findEntry(Index i, Index j) const;
+
+        static const size_t NOT_FOUND = size_t(-1); ///< Returned by findEntry when there is no element
+
+        /// Flag a row as fragmented
+        void markDirty(Index row);
+
+        /// Move a row from the "from segments" bucket of the histogram to the "to segments" one. 0 stands for no bucket (added or removed row)
+        void moveInHistogram(size_t from, size_t to);
+
+        /// Get the fragmentation of the matrix (see Stats)
+        double fragmentation() const;
+
+        /// Defragment if the auto defragment threshold is reached
+        void autoDefragment();
+
+        /// Append the elements of a row, sorted by column index and without duplicates, at the end of buffer. Returns their count
+        Index gatherRow(Index row, std::vector<std::pair<Index, Value>>& buffer) const;
+
+        /// Move every dirty row at the end of the arrays, as a single segment
+        void relocateDirtyRows();
+
+        /// Compact every row in new arrays : parallel sizing of the rows, prefix sum of their offsets, then parallel copy
+        void rebuild();
+
+        /// Split the rows in thread_count ranges : thread t gets the rows [ret_val[t], ret_val[t + 1]).
+        /// The ranges hold the same number of elements when the matrix is consistant, and the same number of rows otherwise
+        std::vector<size_t> rowPartition(size_t thread_count) const;
+
+        static const size_t MIN_NNZ_PER_THREAD = 1 << 15; ///< Below this amount of elements per thread, the kernels use less threads
+
+        // Column index, built on demand by the column getters. Mutable because it is a cache : building it from a const
+        // getter is not thread safe, call getColumnView once before reading the columns from several threads
+        mutable std::vector<Index> csc_start; ///< Start of each column in csc_rows and csc_values, plus the total size at the end
+        mutable std::vector<Index> csc_rows; ///< Row index of each element, sorted inside each column
+        mutable std::vector<Value> csc_values; ///< Value of each element, in the same order as csc_rows
+        mutable bool csc_valid = false; ///< True if the column index matches the rows. addRow invalidates it, addColumn patches it
+
+        /// Chunks and atomic counters of the concurrent append mode, defined in DCSRMatrix.cpp
+        struct AppendState;
+
+        std::shared_ptr<AppendState> append_state; ///< Set between beginConcurrentAppend and seal
 };
 
+typedef BasicDCSRMatrix<uint32_t, double> DCSRMatrix; ///< Matrix used by the Model
+
 }
 
 #endif // _DCSRMATRIX_HPP
\ No newline at end of file
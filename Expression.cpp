@@ -37,17 +37,23 @@ Expression::Expression(Expression&& other){
     std::swap(terms, other.terms);
 }
 
+Expression& Expression::operator=(Expression&& other){
+    std::swap(terms, other.terms);
+
+    return *this;
+}
+
 bool Expression::equals(const Expression& exp) const{
-    return terms == exp.getTerms();
+    return getTerms() == exp.getTerms();
 }
 
 std::string Expression::toString() const {
     std::string ret_val("");
-    for (auto t : terms){
+    for (const auto& t : getTerms()){
         ret_val+=t->toString()+" ";
     }
     
-    if (terms.size() == 0)
+    if (getTerms().size() == 0)
         ret_val+="0";
 
     return ret_val;
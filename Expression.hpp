@@ -110,6 +110,9 @@ class Expression {
         /// Move constructor
         Expression(Expression&& other);
 
+        /// Move assignment operator
+        Expression& operator=(Expression&& other);
+
         /// Virtual destructor
         virtual ~Expression() {}
 
@@ -119,17 +122,17 @@ class Expression {
         //{@
 
         /// Get the begin iterator of the expression
-        std::set<std::shared_ptr<Term>>::const_iterator begin() const { return std::begin(terms); }
+        std::set<std::shared_ptr<Term>>::const_iterator begin() const { return std::begin(getTerms()); }
 
         /// Get the end iterator of the expression
-        std::set<std::shared_ptr<Term>>::const_iterator end() const { return std::end(terms); }
+        std::set<std::shared_ptr<Term>>::const_iterator end() const { return std::end(getTerms()); }
         //@}
 
         /// \name Getters
         //{@
 
-        /// Get the set containing the terms of the expression
-        const std::set<std::shared_ptr<Term>>& getTerms() const { return terms; }
+        /// Get the set containing the terms of the expression. Expressions with their own storage build it on demand
+        virtual const std::set<std::shared_ptr<Term>>& getTerms() const { return terms; }
 
         /// Get the type of the expression
         virtual Expression::Type getType() const = 0;
@@ -8,11 +8,7 @@ ExpressionConstraint::ExpressionConstraint(const std::string& name) : Constraint
 
 ExpressionConstraint::ExpressionConstraint(const ExpressionConstraint& other) : Constraint(other), expr(other.expr), bounds(other.bounds), format(other.format) {}
 
-ExpressionConstraint::ExpressionConstraint(ExpressionConstraint&& other) {
-    std::swap(expr, other.expr);
-    std::swap(bounds, other.bounds);
-    std::swap(format, other.format);
-}
+ExpressionConstraint::ExpressionConstraint(ExpressionConstraint&& other) : Constraint(std::move(other)), expr(std::move(other.expr)), bounds(other.bounds), format(other.format) {}
 
 ExpressionConstraint& ExpressionConstraint::operator=(const ExpressionConstraint& other){
     Constraint::operator=(other);
@@ -24,6 +20,16 @@ ExpressionConstraint& ExpressionConstraint::operator=(const ExpressionConstraint
     return *this;
 }
 
+ExpressionConstraint& ExpressionConstraint::operator=(ExpressionConstraint&& other){
+    Constraint::operator=(std::move(other));
+
+    expr = std::move(other.expr);
+    bounds = other.bounds;
+    format = other.format;
+
+    return *this;
+}
+
 std::string ExpressionConstraint::toString() const{
     std::string ret_val = "("+getName()+")     ";
     if ( getFormat() ==  ExpressionConstraint::Format::EQ ){
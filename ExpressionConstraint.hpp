@@ -28,6 +28,9 @@ class ExpressionConstraint : public Constraint {
         /// Assignment operator
         ExpressionConstraint& operator=(const ExpressionConstraint& other);
 
+        /// Move assignment operator
+        ExpressionConstraint& operator=(ExpressionConstraint&& other);
+
         /// \name Getters
         //{@
 
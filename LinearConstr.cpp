@@ -7,14 +7,16 @@ namespace Osi2 {
 
 LinearConstr::LinearConstr() {}
 
-LinearConstr::LinearConstr(const LinearExpr& expr, const Range& bounds) {
-    setExpr(expr);
+LinearConstr::LinearConstr(const LinearExpr& expr, const Range& bounds) : LinearConstr(LinearExpr(expr), bounds) {}
+
+LinearConstr::LinearConstr(LinearExpr&& expr, const Range& bounds) {
+    setExpr(std::move(expr));
     setBounds(bounds);
     if ( bounds.lower_bound == bounds.upper_bound ){
-         setFormat(ExpressionConstraint::Format::LE);
+         setFormat(ExpressionConstraint::Format::EQ);
     }
     else {
-         setFormat(ExpressionConstraint::Format::EQ);
+         setFormat(ExpressionConstraint::Format::LE);
     }
 }
 
@@ -23,22 +25,34 @@ LinearConstr::LinearConstr(const LinearExpr& expr) {
     setFormat(ExpressionConstraint::Format::LE);
 }
 
+LinearConstr::LinearConstr(LinearExpr&& expr) {
+    setExpr(std::move(expr));
+    setFormat(ExpressionConstraint::Format::LE);
+}
+
 LinearConstr::LinearConstr(const LinearConstr& other) : ExpressionConstraint(other) {
     setExpr(other.getExpr());
     setBounds(other.getBounds());
     setFormat(other.getFormat());
 }
 
-LinearConstr::LinearConstr(LinearConstr&& other) {
-    std::swap(expr, other.expr);
-    setBounds(other.getBounds());
-    setFormat(other.getFormat());
+LinearConstr::LinearConstr(LinearConstr&& other) : ExpressionConstraint(std::move(other)) {}
+
+LinearConstr& LinearConstr::operator=(LinearConstr&& other){
+    ExpressionConstraint::operator=(std::move(other));
+
+    return (*this);
 }
 
-LinearConstr::LinearConstr(const PackedVector& coefs, const Range& bounds, Model& m) {
-    LinearExpr ex(coefs, m);
+ExpressionConstraint&& LinearConstr::checkLinear(ExpressionConstraint&& other){
+    if (other.getType() != Constraint::Type::LINEAR){
+        throw std::invalid_argument("Error, bad conversion");
+    }
+    return std::move(other);
+}
 
-    setExpr(ex);
+LinearConstr::LinearConstr(const PackedVector& coefs, const Range& bounds, Model& m) {
+    setExpr(LinearExpr(coefs, m));
     setBounds(bounds);
     if (bounds.lower_bound == bounds.upper_bound){
         setFormat(ExpressionConstraint::Format::EQ);
@@ -97,6 +111,37 @@ LinearConstr operator<=( double low, const LinearConstr& c){
     return ret_val;
 }
 
+LinearConstr operator<=(LinearConstr&& c, double up){
+    c.setUpperBound(up);
+    if ( c.getBounds().lower_bound == up ){
+        c.setFormat(ExpressionConstraint::Format::EQ);
+    }
+    else {
+       c.setFormat(ExpressionConstraint::Format::LE); 
+    }
+
+    return std::move(c);
+}
+
+LinearConstr operator<=(double low, LinearConstr&& c){
+    c.setLowerBound(low);
+    if ( c.getBounds().upper_bound == low ){
+        c.setFormat(ExpressionConstraint::Format::EQ);
+    }
+    else {
+       c.setFormat(ExpressionConstraint::Format::LE); 
+    }
+
+    return std::move(c);
+}
+
+LinearConstr operator==(LinearConstr&& c, double n){
+    c.setBounds(Range(n));
+    c.setFormat(ExpressionConstraint::Format::EQ);
+
+    return std::move(c);
+}
+
 LinearConstr operator==(const LinearConstr& exp1, double n){
     LinearConstr ret_val;
 
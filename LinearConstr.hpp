@@ -30,6 +30,9 @@ class LinearConstr : public ExpressionConstraint {
             }
         }
 
+        /// Conversion from a temporary ExpressionContraint, adopts its expression
+        LinearConstr(ExpressionConstraint&& other) : ExpressionConstraint(checkLinear(std::move(other))) {}
+
         /// Constructs a linear constraint with a linear expression and a double
         /// This represents a constraint such as : expr = n
         LinearConstr(const LinearExpr& expr, double n);
@@ -38,12 +41,22 @@ class LinearConstr : public ExpressionConstraint {
         /// This represents a constraint such as : bounds.lower_bound <= expr <= bounds.upper_bounds
         LinearConstr(const LinearExpr& expr, const Range& bounds);
 
+        /// Constructs a linear constraint with a temporary linear expression, moved into the constraint, and a Range for bounds
+        LinearConstr(LinearExpr&& expr, const Range& bounds);
+
         /// Constructs a linear constraint via a PackedVector of coefficients, a range, and a reference to a Var container
         LinearConstr(const PackedVector& coefs, const Range& range, Model& m);
 
         /// Allow conversion from a linear expression to a constraint with infinite bounds. Usefull to build constraints with operator overload
         LinearConstr(const LinearExpr& expr);
 
+        /// Conversion from a temporary linear expression, moved into the constraint
+        LinearConstr(LinearExpr&& expr);
+
+        /// Allow conversion from a linear expression template to a constraint with infinite bounds. Usefull to build constraints with operator overload
+        template <typename E>
+        LinearConstr(const LinearExprNode<E>& node) : LinearConstr(LinearExpr(node)) {}
+
         /// Copy constructor
         LinearConstr(const LinearConstr& other);
 
@@ -53,6 +66,9 @@ class LinearConstr : public ExpressionConstraint {
         // Move constructor
         LinearConstr(LinearConstr&& other);
 
+        /// Move assignment operator
+        LinearConstr& operator=(LinearConstr&& other);
+
         // Destructor
         virtual ~LinearConstr(){}
 
@@ -69,12 +85,16 @@ class LinearConstr : public ExpressionConstraint {
         //{@
         virtual void setExpr(const Expression& exp) { this->expr = std::make_shared<LinearExpr>(exp); }
 
+        /// Set the expression inside the constraint, moving a temporary linear expression
+        void setExpr(LinearExpr&& exp) { this->expr = std::make_shared<LinearExpr>(std::move(exp)); }
+
         //@}
 
 
 
     private:
-        //LinearExpr expr; ///< The expression inside the constraint
+        /// Check the type of a constraint before moving from it
+        static ExpressionConstraint&& checkLinear(ExpressionConstraint&& other);
 };
 
 /// \name Operators overload
@@ -89,6 +109,15 @@ LinearConstr operator<=(double up, const LinearConstr& c);
 /// Equal to comparison operator. Used to create constraints in a more mathematical language.
 LinearConstr operator==(const LinearConstr& exp1, double n);
 
+/// Lesser than or equal to comparison operator on a temporary constraint, which is reused instead of copied
+LinearConstr operator<=(LinearConstr&& c, double up);
+
+/// Lesser than or equal to comparison operator on a temporary constraint, which is reused instead of copied
+LinearConstr operator<=(double low, LinearConstr&& c);
+
+/// Equal to comparison operator on a temporary constraint, which is reused instead of copied
+LinearConstr operator==(LinearConstr&& c, double n);
+
 /// Ostream operator
 std::ostream& operator<<(std::ostream& flux, const LinearConstr& constr);
 //@}
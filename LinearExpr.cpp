@@ -2,75 +2,246 @@
 #include "Model.hpp"
 
 #include <cmath>
+#include <algorithm>
 
 namespace Osi2 {
 
 LinearExpr::LinearExpr(){}
 
 LinearExpr::LinearExpr(Var& var){
-    addTerm(std::make_shared<LinearTerm>(1.0, var));
+    addTerm(1.0, var);
 }
 
-LinearExpr::LinearExpr(const Expression& e) : Expression(e) {}
+LinearExpr::LinearExpr(const Expression& e){
+    if (const LinearExpr* l_expr = dynamic_cast<const LinearExpr*>(&e)){ // Same storage, copy the arrays
+        ids = l_expr->ids;
+        variables = l_expr->variables;
+        coefs = l_expr->coefs;
+    }
+    else{
+        for (const auto& t : e.getTerms()){
+            addTerm(t);
+        }
+    }
+}
 
 LinearExpr::LinearExpr(const LinearTerm& lt){
-    addTerm(std::make_shared<LinearTerm>(lt));
+    addTerm(lt.coef, lt.var);
 }
 
 LinearExpr::LinearExpr(const PackedVector& coefs, Model& m){
-    for (const auto& coef : coefs){ // For each coefficient, allocate a LinearTerm and add it to the expression
-        addTerm( std::make_shared<LinearTerm>( coef.second, m.getVariableAtIndex(coef.first) ) );
+    assignColumns(coefs, coefs.size(), [&m](uint32_t j) -> Var& { return m.getVariableAtIndex(j); });
+}
+
+LinearExpr::LinearExpr(const DCSRMatrix::RowView& row, Model& m){
+    assignColumns(row, row.size(), [&m](uint32_t j) -> Var& { return m.getVariableAtIndex(j); });
+}
+
+LinearExpr::LinearExpr(const DCSRMatrix::RowView& row, Var* const* columns){
+    assignColumns(row, row.size(), [columns](uint32_t j) -> Var& { return *columns[j]; });
+}
+
+template <typename Columns, typename VarOf>
+void LinearExpr::assignColumns(const Columns& columns, size_t count, VarOf var_of){
+    ids.reserve(count);
+    variables.reserve(count);
+    this->coefs.reserve(count);
+
+    bool sorted = true;
+    for (const auto& coef : columns){ // For each coefficient, append the Var of the column
+        if (coef.second == 0){ // Explicit zeros are not terms
+            continue;
+        }
+        Var& v = var_of(coef.first);
+        sorted = sorted && (ids.empty() || ids.back() < v.getID());
+        ids.push_back(v.getID());
+        variables.push_back(&v);
+        this->coefs.push_back(coef.second);
+    }
+
+    if (!sorted){ // The columns are not in the same order as the Var ids, or two columns have the same Var : sort the terms and sum the duplicates
+        std::vector<RawTerm>& buffer = rawTermBuffer();
+        buffer.clear();
+        for (size_t i = 0; i < ids.size(); i++){
+            buffer.push_back(RawTerm{ids[i], variables[i], this->coefs[i]});
+        }
+        assignTerms(buffer, true);
     }
 }
 
-LinearExpr::LinearExpr(const LinearExpr& other) : Expression(other) {}
+LinearExpr::LinearExpr(const LinearExpr& other) : Expression(), ids(other.ids), variables(other.variables), coefs(other.coefs) {}
 
 LinearExpr& LinearExpr::operator=(const LinearExpr& other){
-    Expression::operator=(other);
+    if (this != &other){
+        ids = other.ids;
+        variables = other.variables;
+        coefs = other.coefs;
+        invalidateTerms();
+    }
     return (*this);
 }
 
-LinearExpr::LinearExpr(LinearExpr&& other) : Expression(other) {
+LinearExpr::LinearExpr(LinearExpr&& other) : Expression(), ids(std::move(other.ids)), variables(std::move(other.variables)), coefs(std::move(other.coefs)) { // The terms are not stored in the base class
+    other.invalidateTerms();
+}
+
+LinearExpr& LinearExpr::operator=(LinearExpr&& other){
+    if (this != &other){
+        ids = std::move(other.ids);
+        variables = std::move(other.variables);
+        coefs = std::move(other.coefs);
+        invalidateTerms();
+        other.invalidateTerms();
+    }
+    return (*this);
+}
+
+const std::set<std::shared_ptr<Term>>& LinearExpr::getTerms() const {
+    if (!term_set_valid){
+        term_set.clear();
+        for (size_t i = 0; i < ids.size(); i++){
+            term_set.insert(term_set.end(), std::make_shared<LinearTerm>(coefs[i], *variables[i])); // Already sorted, insert at the end
+        }
+        term_set_valid = true;
+    }
+    return term_set;
 }
 
 std::shared_ptr<Expression> LinearExpr::clone() const {
-    auto ret_val = std::make_shared<LinearExpr>();
+    return std::make_shared<LinearExpr>(*this);
+}
 
-    for (auto t : getTerms()){
-        auto temp = dynamic_cast<LinearTerm*>(t.get());
-        ret_val->addTerm( std::make_shared<LinearTerm>( temp->coef, temp->var ) );
+std::string LinearExpr::toString() const {
+    std::string ret_val("");
+    for (size_t i = 0; i < ids.size(); i++){
+        ret_val+=LinearTerm(coefs[i], *variables[i]).toString()+" ";
     }
 
+    if (ids.size() == 0)
+        ret_val+="0";
+
     return ret_val;
 }
 
-void LinearExpr::add(const LinearExpr& expr){
-    for ( const auto& term : expr.getTerms() ){
-        addTerm(term);
+void LinearExpr::merge(const LinearExpr& expr, double scale){
+    if (expr.ids.empty()){
+        return;
     }
+
+    SmallVector<uint32_t, SMALL_SIZE> new_ids;
+    SmallVector<Var*, SMALL_SIZE> new_variables;
+    SmallVector<double, SMALL_SIZE> new_coefs;
+    new_ids.reserve(ids.size() + expr.ids.size());
+    new_variables.reserve(ids.size() + expr.ids.size());
+    new_coefs.reserve(ids.size() + expr.ids.size());
+
+    size_t i = 0, j = 0;
+    while (i < ids.size() || j < expr.ids.size()){ // Merge the two sorted arrays
+        if (j == expr.ids.size() || (i < ids.size() && ids[i] < expr.ids[j])){
+            new_ids.push_back(ids[i]);
+            new_variables.push_back(variables[i]);
+            new_coefs.push_back(coefs[i]);
+            ++i;
+        }
+        else if (i == ids.size() || expr.ids[j] < ids[i]){
+            new_ids.push_back(expr.ids[j]);
+            new_variables.push_back(expr.variables[j]);
+            new_coefs.push_back(scale * expr.coefs[j]);
+            ++j;
+        }
+        else{ // Same Var in both expressions, sum the coefficients
+            double c = coefs[i] + scale * expr.coefs[j];
+            if (c != 0){ // If the sum is zero, the term disappears
+                new_ids.push_back(ids[i]);
+                new_variables.push_back(variables[i]);
+                new_coefs.push_back(c);
+            }
+            ++i;
+            ++j;
+        }
+    }
+
+    ids.swap(new_ids);
+    variables.swap(new_variables);
+    coefs.swap(new_coefs);
+    invalidateTerms();
 }
 
-void LinearExpr::substract(const LinearExpr& expr){
-    for ( const auto& term : expr.getTerms() ){
-        if (LinearTerm* t = static_cast<LinearTerm*>(term.get())){
-            t->coef = -t->coef;
-            addTerm(std::make_shared<LinearTerm>(*t));
-        }      
+void LinearExpr::assignTerms(std::vector<RawTerm>& raw, bool drop_zeros){
+    auto by_id = [](const RawTerm& a, const RawTerm& b){ return a.id < b.id; };
+    if (raw.size() <= 32){ // Stable insertion sort, does not allocate for short expressions
+        for (size_t i = 1; i < raw.size(); i++){
+            RawTerm t = raw[i];
+            size_t j = i;
+            while (j > 0 && t.id < raw[j - 1].id){
+                raw[j] = raw[j - 1];
+                --j;
+            }
+            raw[j] = t;
+        }
     }
+    else if (!std::is_sorted(std::begin(raw), std::end(raw), by_id)){
+        std::stable_sort(std::begin(raw), std::end(raw), by_id); // Stable, so duplicates are summed in order of appearance
+    }
+
+    ids.clear();
+    variables.clear();
+    coefs.clear();
+    ids.reserve(raw.size());
+    variables.reserve(raw.size());
+    coefs.reserve(raw.size());
+
+    size_t i = 0;
+    while (i < raw.size()){
+        size_t j = i + 1;
+        double c = raw[i].coef;
+        while (j < raw.size() && raw[j].id == raw[i].id){ // Sum the duplicates
+            c += raw[j].coef;
+            ++j;
+        }
+        if (c != 0 || (j - i == 1 && !drop_zeros)){ // Like addTerm, a sum equal to zero removes the term
+            ids.push_back(raw[i].id);
+            variables.push_back(raw[i].var);
+            coefs.push_back(c);
+        }
+        i = j;
+    }
+
+    invalidateTerms();
+}
+
+std::vector<LinearExpr::RawTerm>& LinearExpr::rawTermBuffer(){
+    static thread_local std::vector<RawTerm> buffer;
+    return buffer;
+}
+
+void LinearExpr::invalidateTerms(){
+    if (term_set_valid){
+        term_set.clear();
+        term_set_valid = false;
+    }
+}
+
+void LinearExpr::add(const LinearExpr& expr){
+    merge(expr, 1.0);
+}
+
+void LinearExpr::substract(const LinearExpr& expr){
+    merge(expr, -1.0);
 }
 
 void LinearExpr::mult(double scalar){
-    for ( auto term : getTerms()){
-        LinearTerm* t = static_cast<LinearTerm*>(term.get());
-        t->coef*=scalar;
+    for (auto& c : coefs){
+        c*=scalar;
     }
+    invalidateTerms();
 }
 
 void LinearExpr::divide(double scalar){
-    for ( auto term : getTerms()){
-        LinearTerm* t = static_cast<LinearTerm*>(term.get());
-        t->coef/=scalar;
+    for (auto& c : coefs){
+        c/=scalar;
     }
+    invalidateTerms();
 }
 
 void LinearExpr::operator+=(const LinearExpr& expr){
@@ -90,36 +261,45 @@ void LinearExpr::operator/=(double scalar){
 }
 
 void LinearExpr::addTerm(const std::shared_ptr<Term>& t){
-    if ( dynamic_cast<LinearTerm*>(t.get()) ){ // Check if the argument is a LinearTerm
-        auto spot = terms.insert( t ); // Try to insert the term in the expression
-
-        if ( !spot.second  ){ // If the insertion failed, it means that a term with the same variable is already in the expression
-            auto res = spot.first->get()->add(t); // In that case, we add up the 2 terms
-            terms.erase(spot.first); // We delete the existing one
-            if (res != nullptr) // If the sum is not zero
-                terms.insert( res ); // We insert the sum of the 2 terms
-        }
+    if ( LinearTerm* l_term = dynamic_cast<LinearTerm*>(t.get()) ){ // Check if the argument is a LinearTerm
+        addTerm(l_term->coef, l_term->var);
     }
 }
 
 void LinearExpr::addTerm(double coef, Var& v){
-    addTerm(std::make_shared<LinearTerm>(coef, v));
+    uint32_t id = v.getID();
+    size_t pos = std::lower_bound(std::begin(ids), std::end(ids), id) - std::begin(ids); // Look for the Var in the sorted ids
+
+    if (pos < ids.size() && ids[pos] == id){ // A term with the same variable is already in the expression, add up the 2 terms
+        coefs[pos] += coef;
+        if (coefs[pos] == 0){ // If the sum is zero, the term disappears
+            ids.erase(pos);
+            variables.erase(pos);
+            coefs.erase(pos);
+        }
+    }
+    else{
+        ids.insert(pos, id);
+        variables.insert(pos, &v);
+        coefs.insert(pos, coef);
+    }
+    invalidateTerms();
 }
 
 std::ostream& operator<<(std::ostream& flux, const LinearExpr& e){
     bool first_it = true;
-    for (const auto& x : e.getTerms() ){
-        auto term = static_cast<LinearTerm*>(x.get());
-        if ( term->coef >= 0 ){
+    for (size_t i = 0; i < e.size(); i++){
+        double coef = e.getCoef(i);
+        if ( coef >= 0 ){
             if ( first_it)
-                flux << term->coef; 
+                flux << coef; 
             else
-                flux << " + " << term->coef; 
+                flux << " + " << coef; 
         }
         else
-            flux << " - " << std::abs(term->coef);
+            flux << " - " << std::abs(coef);
 
-        flux << " * " << term->var << " ";
+        flux << " * " << e.getVar(i) << " ";
 
 
         first_it = false;
@@ -157,27 +337,4 @@ LinearExpr divide(const LinearExpr& e, double scalar){
 }
 
 
-LinearExpr operator+(const LinearExpr& a, const LinearExpr& b){
-    return sum(a,b);
-}
-
-
-LinearExpr operator-(const LinearExpr& a, const LinearExpr& b){
-    return diff(a,b);
-}
-
-
-LinearExpr operator*(double scalar, const LinearExpr& e){
-    return mult(e, scalar);
-}
-
-
-LinearExpr operator*(const LinearExpr& e, double scalar){
-    return mult(e, scalar);
-}
-
-LinearExpr operator/(const LinearExpr& e, double scalar){
-    return divide(e, scalar);
-}
-
 }
\ No newline at end of file
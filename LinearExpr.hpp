@@ -5,15 +5,22 @@
 #include <functional>
 #include <iostream>
 #include <unordered_map>
+#include <vector>
+#include <type_traits>
 
 #include "Expression.hpp"
 #include "Var.hpp"
 #include "PackedVector.hpp"
+#include "DCSRMatrix.hpp"
+#include "SmallVector.hpp"
 
 namespace Osi2 {
 
 class Model;
 
+template <typename E>
+struct LinearExprNode;
+
 /*! \brief Struct to represent a term in a linear expression 
     
     It inherits Term and is composed of a coefficient.
@@ -76,9 +83,16 @@ struct LinearTerm : public Term {
 
 /*! \brief Class for representing a linear expression
 
+    The terms are stored as parallel arrays of Var ids, Var pointers and coefficients, sorted by Var id.
+    Short expressions are held inline (small-buffer storage), so they do not allocate.
+    Sums and differences are linear merges of the sorted arrays.
+
+    The std::set of Term required by the Expression interface (getTerms, begin, end) is only built on demand, as a read-only snapshot.
  */
 class LinearExpr : public Expression {
     public:
+        /// Number of terms stored without allocation
+        static const size_t SMALL_SIZE = 4;
 
         /// \name Constructors
         //{@
@@ -100,6 +114,12 @@ class LinearExpr : public Expression {
         //Constructs a linear expression from a vector of coefficients and a model
         LinearExpr(const PackedVector& coefs, Model& m);
 
+        /// Constructs a linear expression from a row of a matrix and a model, reading the row in place
+        LinearExpr(const DCSRMatrix::RowView& row, Model& m);
+
+        /// Constructs a linear expression from a row of a matrix, the Var of column j being *columns[j]. The columns are not checked, used by the bulk import of Model
+        LinearExpr(const DCSRMatrix::RowView& row, Var* const* columns);
+
         /// Copy constructor
         LinearExpr(const LinearExpr& other);
 
@@ -108,17 +128,59 @@ class LinearExpr : public Expression {
 
         /// Move constructor
         LinearExpr(LinearExpr&& other);
+
+        /// Move assignment operator
+        LinearExpr& operator=(LinearExpr&& other);
+
+        /// Materializes an unevaluated expression built with the arithmetic operators, in a single sort and merge pass
+        template <typename E>
+        LinearExpr(const LinearExprNode<E>& node){
+            std::vector<RawTerm>& buffer = rawTermBuffer();
+            buffer.clear();
+            node.self().collect(buffer, 1.0);
+            assignTerms(buffer, false);
+        }
         //@}
 
+        /// A term of the expression before it is sorted and merged
+        struct RawTerm {
+            uint32_t id; ///< Id of the Var
+            Var* var; ///< Pointer to the Var
+            double coef; ///< Coefficient of the term
+        };
+
         /// \name Getters
         //{@
 
         /// Get the type of the expression
         Expression::Type getType() const { return Expression::Type::LINEAR; }
-        
+
+        /// Get the set containing the terms of the expression. Built on the first call after a modification
+        const std::set<std::shared_ptr<Term>>& getTerms() const;
 
         /// Clones the LinearExpr
         std::shared_ptr<Expression> clone() const;
+
+        /// String representation of the linear expression
+        std::string toString() const;
+
+        /// Get the number of terms
+        size_t size() const { return ids.size(); }
+
+        /// Get the id of the Var of the i-th term (terms are sorted by Var id)
+        uint32_t getVarID(size_t i) const { return ids[i]; }
+
+        /// Get the Var of the i-th term
+        Var& getVar(size_t i) const { return *variables[i]; }
+
+        /// Get the coefficient of the i-th term
+        double getCoef(size_t i) const { return coefs[i]; }
+
+        /// Get the sorted array of the Var ids
+        const uint32_t* varIDs() const { return ids.data(); }
+
+        /// Get the array of the coefficients, in the same order as the Var ids
+        const double* coefficients() const { return coefs.data(); }
         //@}
 
         /// \name Member operations
@@ -160,13 +222,39 @@ class LinearExpr : public Expression {
         /// Adds a LinearTerm to the expression
         void addTerm(const std::shared_ptr<Term>& t);
 
-        /// Constructs and adds a LinearTerm to the expression
+        /// Constructs and adds a LinearTerm to the expression. Keeps the arrays sorted : to sum many terms in no particular order, use a LinearExprBuilder
         void addTerm(double coef, Var& v);
         //@}
 
         /// Ostream operator overload
         friend std::ostream& operator<<(std::ostream& flux, const LinearExpr& e);
 
+        friend class LinearExprBuilder;
+
+    private:
+        /// Merge scale * expr into the current expression. Terms summing up to zero are removed
+        void merge(const LinearExpr& expr, double scale);
+
+        /// Replace the terms with (column index, coefficient) pairs, the Var of column j being var_of(j)
+        template <typename Columns, typename VarOf>
+        void assignColumns(const Columns& columns, size_t count, VarOf var_of);
+
+        /// Replace the terms with unsorted raw terms : sorts them by Var id and sums the duplicates (in order of appearance).
+        /// Sums equal to zero are removed. If drop_zeros is set, single zero terms are removed too
+        void assignTerms(std::vector<RawTerm>& raw, bool drop_zeros);
+
+        /// Reusable buffer for the materialization of expression templates, one per thread
+        static std::vector<RawTerm>& rawTermBuffer();
+
+        /// Drop the Term set built by getTerms, after a modification
+        void invalidateTerms();
+
+        SmallVector<uint32_t, SMALL_SIZE> ids; ///< Sorted ids of the Var of the terms
+        SmallVector<Var*, SMALL_SIZE> variables; ///< Var of the terms, in the same order as ids
+        SmallVector<double, SMALL_SIZE> coefs; ///< Coefficients of the terms, in the same order as ids
+
+        mutable std::set<std::shared_ptr<Term>> term_set; ///< Snapshot of the terms for the Expression interface
+        mutable bool term_set_valid = false; ///< Is term_set up to date
 };
 
 /// \name Operations
@@ -185,23 +273,162 @@ LinearExpr mult(const LinearExpr& e, double scalar);
 LinearExpr divide(const LinearExpr& e, double scalar);
 //@}
 
-/// \name Arithmetic operator overloads
+/*! \name Expression templates
+
+    The arithmetic operators on Var, LinearTerm and LinearExpr do not compute anything : they build a tree of nodes,
+    known at compile time, that is materialized into a single LinearExpr when it is converted (assignment, constraint, objective...).
+    For instance 3 * x - y + e is materialized with one sort and merge pass over all its terms, instead of one copy of the
+    whole expression per operator.
+
+    Temporary LinearExpr operands are moved into the tree, the other operands are held by reference :
+    materialize a tree in the same full-expression, do not store it with auto.
+ */
 //{@
 
-/// Sum of two linear expressions
-LinearExpr operator+(const LinearExpr& a, const LinearExpr& b);
+/// Base of the nodes of a linear expression template (CRTP)
+template <typename E>
+struct LinearExprNode {
+    /// Get the actual node
+    const E& self() const { return static_cast<const E&>(*this); }
+};
+
+/// Leaf of a linear expression template holding a Var
+struct LinearVarLeaf : public LinearExprNode<LinearVarLeaf> {
+    LinearVarLeaf(Var& v) : var(v) {}
 
-/// Difference of two linear expressions
-LinearExpr operator-(const LinearExpr& a, const LinearExpr& b);
+    void collect(std::vector<LinearExpr::RawTerm>& out, double scale) const {
+        out.push_back({var.getID(), &var, scale});
+    }
 
-/// Multiplication of a linear expression by a scalar
-LinearExpr operator*(double scalar, const LinearExpr& e);
+    Var& var; ///< The Var of the leaf
+};
 
-/// Multiplication of a linear expression by a scalar
-LinearExpr operator*(const LinearExpr& e, double scalar);
+/// Leaf of a linear expression template holding a LinearTerm
+struct LinearTermLeaf : public LinearExprNode<LinearTermLeaf> {
+    LinearTermLeaf(const LinearTerm& t) : var(t.var), coef(t.coef) {}
+
+    void collect(std::vector<LinearExpr::RawTerm>& out, double scale) const {
+        out.push_back({var.getID(), &var, scale * coef});
+    }
 
-/// Division of a linear expression by a scalar
-LinearExpr operator/(const LinearExpr& e, double scalar);
+    Var& var; ///< The Var of the term
+    double coef; ///< The coefficient of the term
+};
+
+/// Leaf of a linear expression template holding a reference to a LinearExpr
+struct LinearExprLeaf : public LinearExprNode<LinearExprLeaf> {
+    LinearExprLeaf(const LinearExpr& e) : expr(e) {}
+
+    void collect(std::vector<LinearExpr::RawTerm>& out, double scale) const {
+        for (size_t i = 0; i < expr.size(); i++){
+            out.push_back({expr.getVarID(i), &expr.getVar(i), scale * expr.getCoef(i)});
+        }
+    }
+
+    const LinearExpr& expr; ///< The expression of the leaf
+};
+
+/// Leaf of a linear expression template owning a temporary LinearExpr, moved into the tree instead of being copied
+struct LinearExprOwnedLeaf : public LinearExprNode<LinearExprOwnedLeaf> {
+    LinearExprOwnedLeaf(LinearExpr&& e) : expr(std::move(e)) {}
+
+    void collect(std::vector<LinearExpr::RawTerm>& out, double scale) const {
+        LinearExprLeaf(expr).collect(out, scale);
+    }
+
+    LinearExpr expr; ///< The expression of the leaf
+};
+
+/// Node of a linear expression template representing left + sign * right
+template <typename L, typename R>
+struct LinearSumNode : public LinearExprNode<LinearSumNode<L, R>> {
+    LinearSumNode(L&& l, R&& r, double s) : left(std::move(l)), right(std::move(r)), sign(s) {}
+
+    void collect(std::vector<LinearExpr::RawTerm>& out, double scale) const {
+        left.collect(out, scale);
+        right.collect(out, sign * scale);
+    }
+
+    L left; ///< Left operand
+    R right; ///< Right operand
+    double sign; ///< 1 for a sum, -1 for a difference
+};
+
+/// Node of a linear expression template representing a multiplication (or a division) by a scalar
+template <typename E>
+struct LinearScaleNode : public LinearExprNode<LinearScaleNode<E>> {
+    LinearScaleNode(E&& e, double s, bool d) : expr(std::move(e)), scalar(s), divide(d) {}
+
+    void collect(std::vector<LinearExpr::RawTerm>& out, double scale) const {
+        size_t first = out.size();
+        expr.collect(out, 1.0);
+        for (size_t i = first; i < out.size(); i++){
+            out[i].coef = divide ? out[i].coef / scalar : out[i].coef * scalar;
+            out[i].coef *= scale;
+        }
+    }
+
+    E expr; ///< Operand
+    double scalar; ///< Scalar factor (or divisor)
+    bool divide; ///< Is it a division
+};
+
+/// Maps the type of an operand to the type of its node in an expression template. Not defined for non linear operands
+template <typename T, typename Enable = void>
+struct LinearOperand {};
+
+template <>
+struct LinearOperand<Var> { typedef LinearVarLeaf type; };
+
+template <>
+struct LinearOperand<LinearTerm> { typedef LinearTermLeaf type; };
+
+template <>
+struct LinearOperand<LinearExpr> { typedef LinearExprLeaf type; };
+
+template <typename T>
+struct LinearOperand<T, typename std::enable_if<std::is_base_of<LinearExprNode<T>, T>::value>::type> { typedef T type; };
+
+/// Node type of a forwarded operand : temporary LinearExpr are owned by the tree, the other types are looked up in LinearOperand
+template <typename T>
+struct LinearForwardedOperand : public LinearOperand<typename std::remove_cv<typename std::remove_reference<T>::type>::type> {};
+
+template <>
+struct LinearForwardedOperand<LinearExpr> { typedef LinearExprOwnedLeaf type; };
+
+/// Node type of a forwarded operand
+template <typename T>
+using LinearOperandType = typename LinearForwardedOperand<T>::type;
+
+/// Sum of two linear operands (Var, LinearTerm, LinearExpr or expression template)
+template <typename A, typename B>
+LinearSumNode<LinearOperandType<A>, LinearOperandType<B>> operator+(A&& a, B&& b){
+    return LinearSumNode<LinearOperandType<A>, LinearOperandType<B>>(LinearOperandType<A>(std::forward<A>(a)), LinearOperandType<B>(std::forward<B>(b)), 1.0);
+}
+
+/// Difference of two linear operands (Var, LinearTerm, LinearExpr or expression template)
+template <typename A, typename B>
+LinearSumNode<LinearOperandType<A>, LinearOperandType<B>> operator-(A&& a, B&& b){
+    return LinearSumNode<LinearOperandType<A>, LinearOperandType<B>>(LinearOperandType<A>(std::forward<A>(a)), LinearOperandType<B>(std::forward<B>(b)), -1.0);
+}
+
+/// Multiplication of a linear operand by a scalar
+template <typename E>
+LinearScaleNode<LinearOperandType<E>> operator*(double scalar, E&& e){
+    return LinearScaleNode<LinearOperandType<E>>(LinearOperandType<E>(std::forward<E>(e)), scalar, false);
+}
+
+/// Multiplication of a linear operand by a scalar
+template <typename E>
+LinearScaleNode<LinearOperandType<E>> operator*(E&& e, double scalar){
+    return LinearScaleNode<LinearOperandType<E>>(LinearOperandType<E>(std::forward<E>(e)), scalar, false);
+}
+
+/// Division of a linear operand by a scalar
+template <typename E>
+LinearScaleNode<LinearOperandType<E>> operator/(E&& e, double scalar){
+    return LinearScaleNode<LinearOperandType<E>>(LinearOperandType<E>(std::forward<E>(e)), scalar, true);
+}
 
 //@}
 
@@ -0,0 +1,25 @@
+#include "LinearExprBuilder.hpp"
+
+namespace Osi2 {
+
+LinearExprBuilder::LinearExprBuilder(){}
+
+LinearExprBuilder::LinearExprBuilder(size_t expected_terms){
+    terms.reserve(expected_terms);
+}
+
+void LinearExprBuilder::add(const LinearExpr& expr, double scale){
+    for (size_t i = 0; i < expr.size(); i++){
+        terms.push_back({expr.getVarID(i), &expr.getVar(i), scale * expr.getCoef(i)});
+    }
+}
+
+LinearExpr LinearExprBuilder::build(){
+    LinearExpr ret_val;
+    ret_val.assignTerms(terms, true);
+    terms.clear();
+
+    return ret_val;
+}
+
+}
@@ -0,0 +1,83 @@
+#ifndef _LINEAREXPRBUILDER_HPP
+#define _LINEAREXPRBUILDER_HPP
+
+#include <vector>
+#include <iterator>
+#include <type_traits>
+
+#include "LinearExpr.hpp"
+
+namespace Osi2 {
+
+/*! \brief Accumulates terms to build a large LinearExpr in one pass
+
+    Adding terms one by one to a LinearExpr keeps it sorted after each insertion.
+    The builder only appends the (Var, coefficient) pairs to a buffer, and sorts them, sums the duplicates and drops the zeros once, when the LinearExpr is built.
+ */
+class LinearExprBuilder {
+    public:
+        /// \name Constructors
+        //{@
+
+        /// Default constructor
+        LinearExprBuilder();
+
+        /// Constructs a builder with room for a given number of terms
+        LinearExprBuilder(size_t expected_terms);
+        //@}
+
+        /// \name Editing functions
+        //{@
+
+        /// Append a term
+        void add(double coef, Var& v) { terms.push_back({v.getID(), &v, coef}); }
+
+        /// Append all the terms of a linear expression, multiplied by scale
+        void add(const LinearExpr& expr, double scale = 1.0);
+
+        /// Append all the terms of a linear expression template, multiplied by scale
+        template <typename E>
+        void add(const LinearExprNode<E>& node, double scale = 1.0) { node.self().collect(terms, scale); }
+
+        /// Make room for n terms
+        void reserve(size_t n) { terms.reserve(n); }
+
+        /// Remove all the terms, keeps the memory
+        void clear() { terms.clear(); }
+        //@}
+
+        /// Get the number of terms appended (duplicates included)
+        size_t size() const { return terms.size(); }
+
+        /// Build the LinearExpr : sorts the terms, sums the duplicates and drops the zeros. The builder is cleared and can be reused
+        LinearExpr build();
+
+    private:
+        std::vector<LinearExpr::RawTerm> terms; ///< Unsorted terms
+};
+
+/// Sum of coef_fn(v) * v for each v in [first, last). The iterators must dereference to a Var& (or to something convertible, like a std::reference_wrapper<Var>) :
+/// for all the Var of a model, use Model::varsBegin() and Model::varsEnd(), whose Var are not const
+template <typename Iterator, typename CoefFunction>
+LinearExpr quicksum(Iterator first, Iterator last, CoefFunction coef_fn){
+    LinearExprBuilder builder;
+    if (std::is_base_of<std::random_access_iterator_tag, typename std::iterator_traits<Iterator>::iterator_category>::value){
+        builder.reserve(std::distance(first, last));
+    }
+
+    for (; first != last; ++first){
+        builder.add(coef_fn(*first), *first);
+    }
+
+    return builder.build();
+}
+
+/// Sum of the Var in [first, last). The iterators must dereference to a Var& (or to something convertible, like a std::reference_wrapper<Var>)
+template <typename Iterator>
+LinearExpr quicksum(Iterator first, Iterator last){
+    return quicksum(first, last, [](Var&){ return 1.0; });
+}
+
+}
+
+#endif // _LINEAREXPRBUILDER_HPP
@@ -2,11 +2,76 @@
 
 #include "LinearConstr.hpp"
 #include "QuadraticConstraint.hpp"
+#include "Parallel.hpp"
 
 #include <iostream>
+#include <algorithm>
+#include <limits>
 
 namespace Osi2 {
 
+namespace {
+
+/// Column of the Var of a given id : a dense array when the ids of the model are close to each other, the id index of the model otherwise
+class ColumnLookup {
+    public:
+        ColumnLookup(const VarStorage& vars, const std::unordered_map<uint32_t, uint32_t>& id_index) : id_index(id_index), first_id(0) {
+            uint32_t last_id = 0;
+            first_id = std::numeric_limits<uint32_t>::max();
+            for (const auto& v : vars){
+                first_id = std::min(first_id, v.getID());
+                last_id = std::max(last_id, v.getID());
+            }
+            if (!vars.empty() && size_t(last_id - first_id) < 4 * vars.size() + 1024){ // The ids of a model are usually consecutive
+                dense.resize(size_t(last_id - first_id) + 1, NO_COLUMN);
+                uint32_t i = 0;
+                for (const auto& v : vars){
+                    dense[v.getID() - first_id] = i++;
+                }
+            }
+        }
+
+        /// Throws std::invalid_argument if the model has no Var of this id
+        uint32_t operator()(uint32_t id) const {
+            uint32_t ret_val = NO_COLUMN;
+            if (dense.empty()){
+                auto it = id_index.find(id);
+                if (it != id_index.end()){
+                    ret_val = it->second;
+                }
+            }
+            else if (id >= first_id && size_t(id - first_id) < dense.size()){
+                ret_val = dense[id - first_id];
+            }
+            if (ret_val == NO_COLUMN){
+                throw std::invalid_argument("No variable of id " + std::to_string(id) + " in this model");
+            }
+            return ret_val;
+        }
+
+    private:
+        static const uint32_t NO_COLUMN = std::numeric_limits<uint32_t>::max(); ///< Mark of the ids without a Var in dense
+
+        const std::unordered_map<uint32_t, uint32_t>& id_index; ///< Id index of the model, used when dense is empty
+        std::vector<uint32_t> dense; ///< Column of each id, from first_id
+        uint32_t first_id; ///< Smallest id of the model
+};
+
+const uint32_t ColumnLookup::NO_COLUMN;
+
+/// Split the rows of CSR arrays in thread_count blocks with about the same number of elements. Block t is [ret_val[t], ret_val[t + 1])
+std::vector<size_t> rowBlocks(const std::vector<size_t>& start, size_t thread_count){
+    size_t rows = start.size() - 1;
+    std::vector<size_t> ret_val(thread_count + 1, rows);
+    ret_val[0] = 0;
+    for (size_t t = 1; t < thread_count; t++){
+        ret_val[t] = std::lower_bound(start.begin(), start.end() - 1, start.back() * t / thread_count) - start.begin();
+    }
+    return ret_val;
+}
+
+}
+
 Model::Model(){}
 
 uint32_t Model::addVariable(Var::Domaine d){
@@ -14,8 +79,10 @@ uint32_t Model::addVariable(Var::Domaine d){
 }
 
 uint32_t Model::addVariable(const Range& range, Var::Domaine d){
-    
     vars.emplace_back(range, d);
+
+    var_id_index.emplace(vars.back().getID(), vars.size() - 1); // The generated name "UNNAMED<id>" is resolved through the id index, see getVariable
+
     return vars.back().getID();
 }
 
@@ -25,31 +92,61 @@ uint32_t Model::addVariable(const std::string& name, Var::Domaine d){
 
 uint32_t Model::addVariable(const std::string& name, const Range& range, Var::Domaine d){
     vars.emplace_back(name, range, d);
+
+    uint32_t index = vars.size() - 1;
+    var_id_index.emplace(vars.back().getID(), index);
+    var_name_index.emplace(name, index); // Does not override a previous variable with the same name
+
     return vars.back().getID();
 }
 
+uint32_t Model::addVariables(uint32_t count, const Range& range, Var::Domaine d){
+    if (count == 0){
+        throw std::invalid_argument("Can not add 0 variables");
+    }
 
-uint32_t Model::addConstraint(const ExpressionConstraint& constraint, const std::string& name){
+    vars.reserve(vars.size() + count); // Allocate the whole block at once
+    var_id_index.reserve(var_id_index.size() + count);
+
+    uint32_t first_id = addVariable(range, d);
+    for (uint32_t i = 1; i < count; i++){
+        addVariable(range, d);
+    }
+
+    return first_id;
+}
+
+bool Model::checkVariables(const ExpressionConstraint& constraint) const{
     bool success = true;
-    std::shared_ptr<Constraint> c;
 
-    //Check if all the variables of the constraint exist in the model
-    auto expr_it = std::begin(constraint);
-    while ( success && expr_it != std::end(constraint) ){ // For each term in the expression of the constraint
-        bool found = false;
-        auto vars_it = std::begin(vars);
-        while (!found && vars_it != std::end(vars)){ // Compare it with the variables stored in the model
-            if ((*vars_it) == expr_it->get()->var) {
-                found = true; // We found the variable in the model
-            }
-            ++vars_it;
+    if (constraint.getExpr().getType() == Expression::Type::LINEAR){ // Read the ids straight from the arrays of the linear expression
+        const LinearExpr& l_expr = static_cast<const LinearExpr&>(constraint.getExpr());
+        for (size_t i = 0; success && i < l_expr.size(); i++){
+            success = var_id_index.find(l_expr.getVarID(i)) != std::end(var_id_index);
         }
-        if (!found){
-            success = false; // The variable does not exist in the model
+    }
+    else{
+        auto expr_it = std::begin(constraint);
+        while ( success && expr_it != std::end(constraint) ){ // For each term in the expression of the constraint
+            success = hasVariable(expr_it->get()->var); // Constant time lookup in the id index of the model
+            ++expr_it;
         }
+    }
 
-        ++expr_it;
+    return success;
+}
+
+void Model::registerConstraint(const std::shared_ptr<Constraint>& c, const std::string& name){
+    if (name != ""){ // If not default name parameter
+        c->setName(name);
     }
+    constraints.push_back(c);
+    indexConstraint(constraints.size() - 1);
+}
+
+uint32_t Model::addConstraint(const ExpressionConstraint& constraint, const std::string& name){
+    bool success = checkVariables(constraint); //Check if all the variables of the constraint exist in the model
+    std::shared_ptr<Constraint> c;
 
     if (success){ 
         switch (constraint.getType()){ // Allocate the new constraint to put in the model, based on its type. Copy constructed from the constraint passed as argument
@@ -64,10 +161,33 @@ uint32_t Model::addConstraint(const ExpressionConstraint& constraint, const std:
                 break;
         }
 
-        if (name != ""){ // If not default name parameter
-            c->setName(name);
+        registerConstraint(c, name);
+    }
+
+    if (success)
+        return c->getID();
+    else
+        return 0;
+}
+
+uint32_t Model::addConstraint(ExpressionConstraint&& constraint, const std::string& name){
+    bool success = checkVariables(constraint); //Check if all the variables of the constraint exist in the model
+    std::shared_ptr<Constraint> c;
+
+    if (success){
+        switch (constraint.getType()){ // Allocate the new constraint to put in the model, based on its type. Adopts the expression of the temporary
+            case Constraint::Type::LINEAR:
+                c = std::make_shared<LinearConstr>(std::move(constraint));
+                break;
+            case Constraint::Type::QUADRATIC:
+                c = std::make_shared<QuadraticConstraint>(std::move(constraint));
+                break;
+            default:
+                // TODO : Add cases here as you add constraints type
+                break;
         }
-        constraints.push_back(c);
+
+        registerConstraint(c, name);
     }
 
     if (success)
@@ -77,15 +197,25 @@ uint32_t Model::addConstraint(const ExpressionConstraint& constraint, const std:
 }
 
 uint32_t Model::addConstraint(const PackedVector& constraints_coef, const Range& range, const std::string& name){
-    if (constraints_coef.size() != 0){
-        for (uint32_t i = vars.size(); i <= constraints_coef.maxIndex(); i++){
-            addVariable();
-        }
+    if (constraints_coef.size() != 0 && constraints_coef.maxIndex() >= vars.size()){ // Add the missing columns
+        addVariables(constraints_coef.maxIndex() + 1 - vars.size());
     }
 
     return addConstraint(LinearConstr(constraints_coef, range, *this), name);
 }
 
+uint32_t Model::addConstraint(const DCSRMatrix::RowView& row, const Range& range, const std::string& name){
+    uint32_t dimension = 0;
+    for (const auto& e : row){
+        dimension = std::max(dimension, e.first + 1);
+    }
+    if (dimension > vars.size()){ // Add the missing columns
+        addVariables(dimension - vars.size());
+    }
+
+    return addConstraint(LinearConstr(LinearExpr(row, *this), range), name);
+}
+
 bool Model::removeConstraint(uint32_t index){
     try{
         constraints.at(index);
@@ -93,79 +223,111 @@ bool Model::removeConstraint(uint32_t index){
         throw std::out_of_range("No constraint at index " + std::to_string(index) + ". Max index is " + std::to_string(constraints.size() -1) );
     }
 
+    std::shared_ptr<Constraint> removed = constraints[index];
+    constraint_id_index.erase(removed->getID());
+    auto name_it = constraint_name_index.find(removed->getName());
+    bool held_name = name_it != std::end(constraint_name_index) && name_it->second == index;
+    if (held_name){
+        constraint_name_index.erase(name_it);
+    }
+
     constraints.erase(std::begin(constraints) + index );
 
+    for (uint32_t i = index; i < constraints.size(); i++){ // Shift the indexes of the constraints that were after the removed one
+        constraint_id_index[constraints[i]->getID()] = i;
+        name_it = constraint_name_index.find(constraints[i]->getName());
+        if (name_it != std::end(constraint_name_index) && name_it->second == i + 1){
+            name_it->second = i;
+        }
+    }
+    if (held_name){ // The name now designates the next constraint that has it, if any
+        indexNextConstraint(removed->getName(), index);
+    }
+
     return true;
 }
 
 bool Model::removeConstraint(const std::string& name){
     bool ret_val = false;
 
-    auto it = std::begin(constraints);
-    while (it != std::end(constraints) && it->get()->getName() != name ) ++it; // Look for the constraint with the given name
-
-    if (it != std::end(constraints)){ // If the constraint was found
-        constraints.erase(it); // Delete it
-        ret_val = true;
+    int index = findConstraint(name);
+    if (index >= 0){
+        ret_val = removeConstraint(index);
     }
 
     return ret_val;
 }
 
 Var& Model::getVariable(uint32_t id){
-    auto it = std::begin(vars);
-    bool found = false;
-    while (!found && it != std::end(vars)) // Search for the variable with the given id
-    {
-        if (it->getID() == id){
-            found = true;
-        }
-        else{
-            ++it;
-        }
-    }
+    auto it = var_id_index.find(id);
 
-    if (!found){
+    if (it == std::end(var_id_index)){
         throw std::invalid_argument("Not variable with id "+std::to_string(id)+" in this model");
     }
-    return *it;
+    return vars[it->second];
 }
 
 Var& Model::getVariable(const std::string& name){
-    auto it = std::begin(vars);
-    bool found = false;
-    while (!found && it != std::end(vars)) // Search for the variable with a given name
-    {
-        if (it->getName() == name){
-            found = true;
+    int index = findVariable(name);
+    if (index < 0){
+        throw std::invalid_argument("Not variable with name "+name+" in this model");
+    }
+    return vars[index];
+}
+
+bool Model::hasVariable(const std::string& name) const {
+    return findVariable(name) >= 0;
+}
+
+int Model::findVariable(const std::string& name) const {
+    auto it = var_name_index.find(name);
+    if (it != std::end(var_name_index) && vars[it->second].getName() == name){ // The entry is stale if the Var was renamed with Var::setName
+        return it->second;
+    }
+
+    const std::string prefix("UNNAMED");
+    if (name.compare(0, prefix.size(), prefix) == 0 && name.size() > prefix.size() && name.size() <= prefix.size() + 10
+        && name.find_first_not_of("0123456789", prefix.size()) == std::string::npos){ // Generated names are not stored in the name index, they carry the id of the Var
+        auto id_it = var_id_index.find(std::stoul(name.substr(prefix.size())));
+        if (id_it != std::end(var_id_index) && vars[id_it->second].getName() == name){
+            return id_it->second;
         }
-        else{
-            ++it;
+    }
+
+    return -1;
+}
+
+void Model::renameVariable(uint32_t id, const std::string& name){
+    Var& v = getVariable(id);
+    uint32_t index = var_id_index.at(id);
+
+    auto it = var_name_index.find(v.getName());
+    if (it != std::end(var_name_index) && it->second == index){ // The old name now designates the next variable that has it, if any
+        var_name_index.erase(it);
+        for (uint32_t i = index + 1; i < vars.size(); i++){
+            if (vars[i].getName() == v.getName()){
+                var_name_index.emplace(v.getName(), i);
+                break;
+            }
         }
     }
 
-    if (!found){
-        throw std::invalid_argument("Not variable with name "+name+" in this model");
+    v.setName(name);
+    auto new_it = var_name_index.find(name);
+    if (new_it == std::end(var_name_index) || new_it->second > index){ // The first variable registered with a name keeps it
+        var_name_index[name] = index;
     }
-    return *it;
+}
+
+bool Model::hasVariable(const Var& var) const {
+    return var_id_index.find(var.getID()) != std::end(var_id_index);
 }
 
 int Model::getVariableIndex(const Var& var) const {
-    int index = 0;
-    bool found = false;
-    auto it = std::begin(vars);
-    while ( !found && it != std::end(vars) ){
-        if ( equals(*it, var) ){
-            found = true;
-        }
-        else{
-            ++index;
-        }
-        ++it;
-    }
+    auto it = var_id_index.find(var.getID());
 
-    if (found)
-        return index;
+    if (it != std::end(var_id_index))
+        return it->second;
     else
         return -1;
 }
@@ -186,41 +348,58 @@ Var& Model::operator[](const std::string& name){
 }
 
 Constraint& Model::getConstraint(uint32_t id){
-    auto it = std::begin(constraints);
-    bool found = false;
-    while (!found && it != std::end(constraints)) // Look for the constraint with a given id
-    {
-        if (it->get()->getID() == id){
-            found = true;
-        }
-        else{
-            ++it;
-        }
-    }
+    auto it = constraint_id_index.find(id);
 
-    if (!found){
+    if (it == std::end(constraint_id_index)){
         throw std::invalid_argument("Not constraint with id "+std::to_string(id)+" in this model");
     }
-    return *(it->get());
+    return *constraints[it->second];
 }
 
 Constraint& Model::getConstraint(const std::string& name){
-    auto it = std::begin(constraints);
-    bool found = false;
-    while (!found && it != std::end(constraints)) // Look for the constraint with a given name
-    {
-        if (it->get()->getName() == name){
-            found = true;
-        }
-        else{
-            ++it;
-        }
+    int index = findConstraint(name);
+    if (index < 0){
+        throw std::invalid_argument("Not constraint with name "+name+" in this model");
+    }
+    return *constraints[index];
+}
+
+bool Model::hasConstraint(const std::string& name) const {
+    return findConstraint(name) >= 0;
+}
+
+int Model::findConstraint(const std::string& name) const {
+    auto it = constraint_name_index.find(name);
+    if (it != std::end(constraint_name_index) && constraints[it->second]->getName() == name){ // The entry is stale if the Constraint was renamed with Constraint::setName
+        return it->second;
     }
+    return -1;
+}
+
+void Model::renameConstraint(uint32_t id, const std::string& name){
+    Constraint& c = getConstraint(id);
+    uint32_t index = constraint_id_index.at(id);
 
-    if (!found){
-        throw std::invalid_argument("Not constraint with id "+name+" in this model");
+    auto it = constraint_name_index.find(c.getName());
+    if (it != std::end(constraint_name_index) && it->second == index){ // The old name now designates the next constraint that has it, if any
+        constraint_name_index.erase(it);
+        indexNextConstraint(c.getName(), index + 1);
+    }
+
+    c.setName(name);
+    auto new_it = constraint_name_index.find(name);
+    if (new_it == std::end(constraint_name_index) || new_it->second > index){ // The first constraint registered with a name keeps it
+        constraint_name_index[name] = index;
+    }
+}
+
+void Model::indexNextConstraint(const std::string& name, uint32_t from){
+    for (uint32_t i = from; i < constraints.size(); i++){
+        if (constraints[i]->getName() == name){
+            constraint_name_index.emplace(name, i);
+            break;
+        }
     }
-    return *(it->get());
 }
 
 Constraint& Model::operator()(uint32_t id){
@@ -231,6 +410,12 @@ Constraint& Model::operator()(const std::string& name){
     return getConstraint(name);
 }
 
+void Model::indexConstraint(uint32_t position){
+    const Constraint& c = *constraints[position];
+    constraint_id_index[c.getID()] = position;
+    constraint_name_index.emplace(c.getName(), position); // Does not override a previous constraint with the same name
+}
+
 Model::Type Model::getType() const {
     Model::Type ret_val = Model::Type::LINEAR;
     uint32_t val;
@@ -255,49 +440,197 @@ Model::Type Model::getType() const {
     return ret_val;
 }
 
-MatrixHelper Model::toMatrix() const{
-    MatrixHelper ret_val;    
-    DCSRMatrix matrix(0, vars.size());
-    std::vector<double> lower_b;
-    std::vector<double> upper_b;
-
-    PackedVector v;
-    for (const auto& c : constraints){ // For each constraint
-        if (c->getType() == Constraint::Type::LINEAR){ // If it is linear
-            ExpressionConstraint* exp_c = static_cast<ExpressionConstraint*>(c.get());
-            for (const auto& e : exp_c->getExpr().getTerms()){ // Add each of its coefficients to a PackedVector
-                LinearTerm* term = static_cast<LinearTerm*>(e.get());
-                uint32_t v_ind = getVariableIndex(e->var); // Get to which column a variable belongs
-                v.insert( v_ind, term->coef );
+SparseMatrix Model::toCSR(const std::string& objective) const{
+    SparseMatrix ret_val;
+    ret_val.order = SparseMatrix::Order::ROW;
+    ret_val.col_count = vars.size();
+
+    std::vector<const ExpressionConstraint*> rows; // Linear constraints, in the order of the model
+    rows.reserve(constraints.size());
+    for (const auto& c : constraints){
+        if (c->getType() == Constraint::Type::LINEAR){
+            rows.push_back(static_cast<const ExpressionConstraint*>(c.get()));
+        }
+    }
+    ret_val.row_count = rows.size();
+
+    ret_val.start.assign(rows.size() + 1, 0);
+    ret_val.row_lower.resize(rows.size());
+    ret_val.row_upper.resize(rows.size());
+    for (size_t i = 0; i < rows.size(); i++){
+        ret_val.start[i + 1] = ret_val.start[i] + static_cast<const LinearExpr&>(rows[i]->getExpr()).size();
+        ret_val.row_lower[i] = rows[i]->getLowerBound();
+        ret_val.row_upper[i] = rows[i]->getUpperBound();
+    }
+    ret_val.index.resize(ret_val.start.back());
+    ret_val.value.resize(ret_val.start.back());
+
+    ColumnLookup column(vars, var_id_index);
+    size_t thread_count = threadCountFor(ret_val.start.back(), MIN_TERMS_PER_THREAD);
+    std::vector<size_t> blocks = rowBlocks(ret_val.start, thread_count);
+    parallelFor(thread_count, [&](size_t t){ // Each thread writes its own block of rows
+        for (size_t i = blocks[t]; i < blocks[t + 1]; i++){
+            const LinearExpr& l_expr = static_cast<const LinearExpr&>(rows[i]->getExpr());
+            const uint32_t* ids = l_expr.varIDs();
+            const double* coefs = l_expr.coefficients();
+            size_t pos = ret_val.start[i];
+            for (size_t k = 0; k < l_expr.size(); k++){ // The terms are sorted by Var id, and the ids grow with the columns, so the row is sorted
+                ret_val.index[pos + k] = column(ids[k]);
+                ret_val.value[pos + k] = coefs[k];
+            }
+        }
+    });
+
+    ret_val.col_lower.assign(vars.size(), Range::NEGATIVE_INFINITY);
+    ret_val.col_upper.assign(vars.size(), Range::POSITIVE_INFINITY);
+    uint32_t j = 0;
+    for (const auto& v : vars){ // The bounds of a variable with several ranges are the hull of its ranges
+        const std::vector<Range>& ranges = v.getRanges();
+        if (!ranges.empty()){
+            ret_val.col_lower[j] = ranges[0].lower_bound;
+            ret_val.col_upper[j] = ranges[0].upper_bound;
+            for (const auto& r : ranges){
+                ret_val.col_lower[j] = std::min(ret_val.col_lower[j], r.lower_bound);
+                ret_val.col_upper[j] = std::max(ret_val.col_upper[j], r.upper_bound);
+            }
+        }
+        ++j;
+    }
+
+    ret_val.objective.assign(vars.size(), 0.0);
+    if (objective != ""){
+        auto it = objectives.find(objective);
+        if (it == std::end(objectives)){
+            throw std::invalid_argument("No objective function named " + objective + " in this model");
+        }
+        if (it->second.expr->getType() != Expression::Type::LINEAR){
+            throw std::invalid_argument("Objective function " + objective + " is not linear");
+        }
+        const LinearExpr& l_expr = static_cast<const LinearExpr&>(*it->second.expr);
+        for (size_t k = 0; k < l_expr.size(); k++){
+            ret_val.objective[column(l_expr.getVarID(k))] += l_expr.getCoef(k);
+        }
+    }
+
+    return ret_val;
+}
+
+SparseMatrix Model::toCSC(const std::string& objective) const{
+    SparseMatrix csr = toCSR(objective);
+    SparseMatrix ret_val;
+    ret_val.order = SparseMatrix::Order::COLUMN;
+    ret_val.row_count = csr.row_count;
+    ret_val.col_count = csr.col_count;
+
+    size_t nnz = csr.start.back();
+    size_t thread_count = threadCountFor(nnz, MIN_TERMS_PER_THREAD);
+    std::vector<size_t> blocks = rowBlocks(csr.start, thread_count);
+    std::vector<std::vector<size_t>> next(thread_count, std::vector<size_t>(csr.col_count, 0)); // Elements of each column in each block of rows, then where the block writes the next one
+
+    parallelFor(thread_count, [&](size_t t){
+        for (size_t k = csr.start[blocks[t]]; k < csr.start[blocks[t + 1]]; k++){
+            ++next[t][csr.index[k]];
+        }
+    });
+
+    ret_val.start.resize(csr.col_count + 1);
+    size_t running = 0;
+    for (uint32_t j = 0; j < csr.col_count; j++){ // The blocks write their part of a column one after the other, so the rows stay sorted
+        ret_val.start[j] = running;
+        for (size_t t = 0; t < thread_count; t++){
+            size_t count = next[t][j];
+            next[t][j] = running;
+            running += count;
+        }
+    }
+    ret_val.start[csr.col_count] = running;
+
+    ret_val.index.resize(nnz);
+    ret_val.value.resize(nnz);
+    parallelFor(thread_count, [&](size_t t){
+        for (size_t i = blocks[t]; i < blocks[t + 1]; i++){
+            for (size_t k = csr.start[i]; k < csr.start[i + 1]; k++){
+                size_t pos = next[t][csr.index[k]]++;
+                ret_val.index[pos] = i;
+                ret_val.value[pos] = csr.value[k];
             }
-            matrix.addRow(v); // Then add the PackedVector as a new row in the matrix
-            lower_b.push_back(exp_c->getLowerBound());
-            upper_b.push_back(exp_c->getUpperBound());
-            v.clear();
         }
+    });
+
+    ret_val.row_lower = std::move(csr.row_lower);
+    ret_val.row_upper = std::move(csr.row_upper);
+    ret_val.col_lower = std::move(csr.col_lower);
+    ret_val.col_upper = std::move(csr.col_upper);
+    ret_val.objective = std::move(csr.objective);
+
+    return ret_val;
+}
+
+MatrixHelper Model::toMatrix() const{
+    MatrixHelper ret_val;
+    SparseMatrix csr = toCSR();
+
+    std::vector<uint32_t> rows(csr.index.size()); // Row of each element, the triplets are already sorted so fromTriplets does not sort them
+    for (uint32_t i = 0; i < csr.row_count; i++){
+        std::fill(rows.begin() + csr.start[i], rows.begin() + csr.start[i + 1], i);
     }
 
-    ret_val.matrix = matrix;
-    ret_val.lower_bounds = lower_b;
-    ret_val.upper_bounds = upper_b;
+    ret_val.matrix = DCSRMatrix::fromTriplets(rows, csr.index, csr.value, csr.row_count, csr.col_count);
+    ret_val.lower_bounds = std::move(csr.row_lower);
+    ret_val.upper_bounds = std::move(csr.row_upper);
 
     return ret_val;
 }
 
+void Model::importRows(const DCSRMatrix& matrix, const std::vector<double>& lower_bounds, const std::vector<double>& upper_bounds, const std::vector<std::string>* names){
+    uint32_t row_count = matrix.getRowCount();
+    if (lower_bounds.size() < row_count || upper_bounds.size() < row_count){
+        throw std::invalid_argument("Bounds given for " + std::to_string(std::min(lower_bounds.size(), upper_bounds.size())) + " rows, the matrix has " + std::to_string(row_count));
+    }
+    if (names != nullptr && names->size() < row_count){
+        throw std::invalid_argument("Names given for " + std::to_string(names->size()) + " rows, the matrix has " + std::to_string(row_count));
+    }
+
+    if (matrix.getColumnCount() > vars.size()){ // Add the missing columns at once
+        addVariables(matrix.getColumnCount() - vars.size());
+    }
+
+    std::vector<Var*> columns; // Var of each column, so that the rows do not look them up in the storage
+    columns.reserve(vars.size());
+    for (auto& v : vars){
+        columns.push_back(&v);
+    }
+
+    constraints.reserve(constraints.size() + row_count);
+    constraint_id_index.reserve(constraint_id_index.size() + row_count);
+    constraint_name_index.reserve(constraint_name_index.size() + row_count);
+
+    for (uint32_t i = 0; i < row_count; i++){ // The expression is moved into the constraint, which is registered without checking its variables again
+        std::shared_ptr<Constraint> c = std::make_shared<LinearConstr>(LinearExpr(matrix.getRowView(i), columns.data()), Range(lower_bounds[i], upper_bounds[i]));
+        registerConstraint(c, names != nullptr ? (*names)[i] : std::string());
+    }
+}
+
 void Model::fromMatrix(const MatrixHelper& helper){
+    fromMatrix(helper.matrix, helper.lower_bounds, helper.upper_bounds);
+}
+
+void Model::fromMatrix(const DCSRMatrix& matrix, const std::vector<double>& lower_bounds, const std::vector<double>& upper_bounds){
     try{
-        for (uint32_t i = 0; i < helper.matrix.getRowCount(); i++){
-            addConstraint(helper.matrix.getRow(i), Range(helper.lower_bounds[i], helper.upper_bounds[i]));
-        }
+        importRows(matrix, lower_bounds, upper_bounds, nullptr);
     }
     catch(const std::exception& e){
         std::cerr << "Error while importing matrix coefficients as constraints : \n" << e.what();
     }
 }
 
-void Model::fromMatrix(const DCSRMatrix& matrix, const std::vector<double>& lower_bounds, const std::vector<double>& upper_bounds){
-    MatrixHelper helper = { matrix, lower_bounds, upper_bounds };
-    fromMatrix(helper);
+void Model::fromMatrix(const DCSRMatrix& matrix, const std::vector<double>& lower_bounds, const std::vector<double>& upper_bounds, const std::vector<std::string>& names){
+    try{
+        importRows(matrix, lower_bounds, upper_bounds, &names);
+    }
+    catch(const std::exception& e){
+        std::cerr << "Error while importing matrix coefficients as constraints : \n" << e.what();
+    }
 }
 
 void Model::display(){
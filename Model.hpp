@@ -2,9 +2,11 @@
 #define _MODEL_HPP
 
 #include "DCSRMatrix.hpp"
+#include "VarStorage.hpp"
 
 #include "ExpressionConstraint.hpp"
 #include "LinearConstr.hpp"
+#include "LinearExprBuilder.hpp"
 #include "QuadraticConstraint.hpp"
 
 #include <set>
@@ -25,6 +27,32 @@ struct MatrixHelper {
     std::vector<double> upper_bounds;
 };
 
+/*! \brief Compressed sparse row (CSR) or column (CSC) arrays of the linear constraints of a Model
+
+    Filled by Model::toCSR and Model::toCSC, in the layout the solvers load : the elements of the k-th row (CSR) or column (CSC)
+    are at positions [start[k], start[k + 1]) of index and value, sorted by index. The members are plain vectors, a solver
+    shim can std::move them or pass their data() without copying.
+*/
+struct SparseMatrix {
+    /// Major dimension of the arrays
+    enum class Order {
+        ROW, ///< CSR : start has one entry per row, index holds columns
+        COLUMN ///< CSC : start has one entry per column, index holds rows
+    };
+
+    Order order = Order::ROW; ///< Layout of start, index and value
+    uint32_t row_count = 0; ///< Number of rows (linear constraints)
+    uint32_t col_count = 0; ///< Number of columns (variables)
+    std::vector<size_t> start; ///< Start of each row or column in index and value, plus the element count at the end
+    std::vector<uint32_t> index; ///< Column (CSR) or row (CSC) of each element
+    std::vector<double> value; ///< Coefficient of each element
+    std::vector<double> row_lower; ///< Lower bound of each row
+    std::vector<double> row_upper; ///< Upper bound of each row
+    std::vector<double> col_lower; ///< Lower bound of each column, the smallest one of the ranges of the variable
+    std::vector<double> col_upper; ///< Upper bound of each column, the largest one of the ranges of the variable
+    std::vector<double> objective; ///< Objective coefficient of each column, zeros if no objective function was exported
+};
+
 /*! \brief Representation of an objective function
     
     An objective function is composed of an expression and a type (MINIMIZE or MAXIMIZE)
@@ -54,7 +82,8 @@ struct Objective {
 
 /*! \brief Main class for representing the model of a problem
 
-    The purpose of this class is to centralize all the data related to a problem
+    The purpose of this class is to centralize all the data related to a problem.
+    The Var of the model never move in memory, so references to them (and the expressions built with them) stay valid when variables are added.
  */
 class Model {
 
@@ -89,12 +118,27 @@ class Model {
         /// Add a variable to the model, give it a name and a Range. Returns its id
         uint32_t addVariable(const std::string& name, const Range& range, Var::Domaine d = Var::Domaine::REAL);
 
+        /// Add count variables to the model at once, all with the same Range. Their ids are consecutive, returns the id of the first one
+        uint32_t addVariables(uint32_t count, const Range& range = Range(), Var::Domaine d = Var::Domaine::REAL);
+
+        /// Rename the variable of a given id and update the name index. A Var renamed with Var::setName is no longer found by name
+        void renameVariable(uint32_t id, const std::string& name);
+
+        /// Rename the constraint of a given id and update the name index. A Constraint renamed with Constraint::setName is no longer found by name
+        void renameConstraint(uint32_t id, const std::string& name);
+
         /// Add a given constraint to the model, and give it a name. Returns its id
         uint32_t addConstraint(const ExpressionConstraint& constraint, const std::string& name = ""); //TODO : check names before registering the constraint
 
+        /// Add a temporary constraint to the model, its expression is moved into the model instead of being copied. Returns its ID, or 0 if a variable is not in the model
+        uint32_t addConstraint(ExpressionConstraint&& constraint, const std::string& name = "");
+
         /// Add a constraint created using a PackedVector of coefficients and a Range, and give it a name
         uint32_t addConstraint(const PackedVector& constraints_coef, const Range& range, const std::string& name = "");
 
+        /// Add a constraint with the coefficients of a matrix row, read in place. Columns missing in the model are added as variables
+        uint32_t addConstraint(const DCSRMatrix::RowView& row, const Range& range, const std::string& name = "");
+
         /// Remove the constraint designated by the index
         bool removeConstraint(uint32_t index);
 
@@ -115,12 +159,21 @@ class Model {
         /// Get the objective function designated by the name
         const Objective& getObjectiveFun(const std::string& name) const { return objectives.at(name); }
 
+        /// Check if the model has an objective function of a given name
+        bool hasObjectiveFun(const std::string& name) const { return objectives.find(name) != std::end(objectives); }
+
         /// Get a Var via its id
         Var& getVariable(uint32_t id);
 
-        /// Get a Var via its name
+        /// Get a Var via its name, in constant time : the name index (or the id for the generated names UNNAMED<id>). Throws std::invalid_argument if there is none
         Var& getVariable(const std::string& name);
 
+        /// Check if a Var belongs to the model, in constant time
+        bool hasVariable(const Var& v) const;
+
+        /// Check if a Var of the model has a given name, in constant time, see getVariable(name)
+        bool hasVariable(const std::string& name) const;
+
         /// Get the index of a variable in the vector
         int getVariableIndex(const Var& v) const;
 
@@ -133,18 +186,27 @@ class Model {
         /// Get a Var via its name with operator overload
         Var& operator[](const std::string& name);
 
-        /// Get the begin iterator from the vector of Var
-        std::vector<Var>::const_iterator varsIteratorBegin() const { return std::begin(vars); };
+        /// Get the begin iterator from the storage of Var
+        VarStorage::const_iterator varsIteratorBegin() const { return std::begin(vars); };
 
-        /// Get the end iterator from the vector of Var
-        std::vector<Var>::const_iterator varsIteratorEnd() const { return std::end(vars); };
+        /// Get the end iterator from the storage of Var
+        VarStorage::const_iterator varsIteratorEnd() const { return std::end(vars); };
+
+        /// Get the begin iterator over the Var of the model, that can be modified and put in expressions, as with quicksum(m.varsBegin(), m.varsEnd())
+        VarStorage::iterator varsBegin() { return std::begin(vars); }
+
+        /// Get the end iterator over the Var of the model, see varsBegin
+        VarStorage::iterator varsEnd() { return std::end(vars); }
 
         /// Get a Constraint via its id
         Constraint& getConstraint(uint32_t id);
 
-        /// Get a Constraint via its name
+        /// Get a Constraint via its name, in constant time through the name index. Throws std::invalid_argument if there is none
         Constraint& getConstraint(const std::string& name);
 
+        /// Check if a Constraint of the model has a given name, in constant time, see getConstraint(name)
+        bool hasConstraint(const std::string& name) const;
+
         /// Get a Constraint via its id with operator overload
         Constraint& operator()(uint32_t id);
 
@@ -161,7 +223,19 @@ class Model {
         std::vector<std::shared_ptr<Constraint>>::const_iterator constraintsIteratorEnd() const { return std::end(constraints); } ;
         //@}
         
-        /// Export the constraint's coefficients as a DCSRMatrix, in the case of a linear problem, using the MatrixHelper
+        /*! \brief Export the linear constraints as CSR arrays, with the bounds of the rows and columns
+
+            One pass over the constraints, split between threads by blocks of rows. Non linear constraints are skipped.
+            objective names the objective function whose coefficients are exported, none if empty.
+            Throws std::invalid_argument if there is no such objective function, if it is not linear, or if it uses a Var that is not
+            in the model (addObjectiveFun does not check them).
+         */
+        SparseMatrix toCSR(const std::string& objective = "") const;
+
+        /// Export the linear constraints as CSC arrays : toCSR followed by a parallel transposition
+        SparseMatrix toCSC(const std::string& objective = "") const;
+
+        /// Export the constraint's coefficients as a DCSRMatrix, in the case of a linear problem, using the MatrixHelper. Built from toCSR
         MatrixHelper toMatrix() const;
 
         /// Import a matrix of coefficient as constraints in the model using the MatrixHelper
@@ -170,13 +244,50 @@ class Model {
         /// Import a matrix of coefficient as constraints in the model
         void fromMatrix(const DCSRMatrix& matrix, const std::vector<double>& lower_bounds, const std::vector<double>& upper_bounds);
 
+        /// Import a matrix of coefficient as constraints in the model, and give them names (an empty name keeps the default one)
+        void fromMatrix(const DCSRMatrix& matrix, const std::vector<double>& lower_bounds, const std::vector<double>& upper_bounds, const std::vector<std::string>& names);
+
+        /*! \brief Bulk import behind fromMatrix : one linear constraint per row of the matrix, named if names is not null
+
+            The missing columns are added as variables in a single step and the containers are sized once. The expressions are built
+            straight from the rows, with the Var of each column read from a table, and the constraints are not checked again.
+            Unlike fromMatrix, which prints the errors, throws std::invalid_argument, before modifying the model, if a bound or name
+            array is shorter than the row count.
+         */
+        void importRows(const DCSRMatrix& matrix, const std::vector<double>& lower_bounds, const std::vector<double>& upper_bounds, const std::vector<std::string>* names);
+
         /// For debug purpose only
         void display();
 
     private:
+        /// Register the constraint at a given position in the lookup indexes
+        void indexConstraint(uint32_t position);
+
+        /// Check that every variable of the constraint is in the model
+        bool checkVariables(const ExpressionConstraint& constraint) const;
+
+        /// Index of the Var of a given name, -1 if there is none, see getVariable(name)
+        int findVariable(const std::string& name) const;
+
+        /// Index of the Constraint of a given name, -1 if there is none, see getConstraint(name)
+        int findConstraint(const std::string& name) const;
+
+        /// Index under a name the first constraint from position from that has it
+        void indexNextConstraint(const std::string& name, uint32_t from);
+
+        /// Name the constraint, append it to the model and index it
+        void registerConstraint(const std::shared_ptr<Constraint>& c, const std::string& name);
+
+        static const size_t MIN_TERMS_PER_THREAD = 1 << 15; ///< Below this amount of terms per thread, the exports use less threads
+
         std::unordered_map<std::string, Objective> objectives; ///< Map of the objective functions
-        std::vector<Var> vars; ///< Vector of the variables in the problem
+        VarStorage vars; ///< Variables of the problem. Their addresses never change, so the Var& held by expressions stay valid as the model grows
         std::vector<std::shared_ptr<Constraint>> constraints; ///< Vector of constraints
+
+        std::unordered_map<uint32_t, uint32_t> var_id_index; ///< Maps the id of a Var to its index in vars
+        std::unordered_map<std::string, uint32_t> var_name_index; ///< Maps the name of a Var to its index in vars (first one registered in case of duplicates). Generated names are not stored
+        std::unordered_map<uint32_t, uint32_t> constraint_id_index; ///< Maps the id of a Constraint to its index in constraints
+        std::unordered_map<std::string, uint32_t> constraint_name_index; ///< Maps the name of a Constraint to its index in constraints (first one registered in case of duplicates)
 };
 
 }
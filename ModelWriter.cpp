@@ -0,0 +1,438 @@
+#include "ModelWriter.hpp"
+
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace Osi2 {
+
+namespace {
+
+/// Type of the MPS row of a constraint : E if its bounds are equal, L if it only has an upper bound, G otherwise (a free row is G with -1e30)
+char rowType(double lower, double upper){
+    if (lower == upper){
+        return 'E';
+    }
+    if (std::isinf(lower) && !std::isinf(upper)){
+        return 'L';
+    }
+    return 'G';
+}
+
+/// Check if a column is written as a binary : BIN domain and [0, 1] bounds. The other BIN columns are written as integers
+inline bool isBinary(Var::Domaine domain, double lower, double upper){
+    return domain == Var::Domaine::BIN && lower == 0 && upper == 1;
+}
+
+/// Check if a character can be part of a name in the LP format
+inline bool isLpNameChar(char c){
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || std::strchr("!\"#$%&()/,.;?@_`'{}|~", c) != nullptr;
+}
+
+}
+
+ModelWriter::ModelWriter(Format format) : format(format), out(nullptr), used(0), line_start(0), bytes_written(0) {}
+
+void ModelWriter::write(const std::string& path, const Model& m, const std::string& objective){
+    std::ofstream file(path, std::ios::binary);
+    if (!file){
+        throw std::invalid_argument("Can not open file " + path);
+    }
+    write(file, m, objective);
+}
+
+void ModelWriter::write(std::ostream& out, const Model& m, const std::string& objective){
+    SparseMatrix a = format == Format::MPS ? m.toCSC(objective) : m.toCSR(objective); // Throws if the objective function is missing or not linear
+    bool maximize = objective != "" && m.getObjectiveFun(objective).type == Objective::Type::MAXIMIZE;
+    std::string objective_row = objective != "" ? objective : "OBJ";
+    collectNames(m, objective_row);
+
+    this->out = &out;
+    buffer.resize(BUFFER_SIZE);
+    used = 0;
+    line_start = 0;
+    bytes_written = 0;
+
+    if (format == Format::MPS){
+        writeMps(a, objective_row, maximize);
+    }
+    else{
+        writeLp(a, objective_row, maximize);
+    }
+
+    flush();
+    out.flush();
+    if (!out){
+        throw std::runtime_error("Can not write the model");
+    }
+}
+
+void ModelWriter::collectNames(const Model& m, const std::string& objective_row){
+    name_text.clear();
+    col_names.clear();
+    domains.clear();
+    row_names.clear();
+
+    checkName(objective_row);
+    std::vector<size_t> ends; // End of each name in name_text, the views are made once the text is complete
+    for (auto it = m.varsIteratorBegin(); it != m.varsIteratorEnd(); ++it){
+        checkName(it->getName());
+        name_text += it->getName();
+        ends.push_back(name_text.size());
+        domains.push_back(it->getDomaine());
+    }
+    size_t col_count = ends.size();
+    for (auto it = m.constraintsIteratorBegin(); it != m.constraintsIteratorEnd(); ++it){ // Same rows as toCSR, the linear constraints in order
+        if ((*it)->getType() != Constraint::Type::LINEAR){
+            continue;
+        }
+        const std::string& name = (*it)->getName();
+        checkName(name);
+        if (name == objective_row){
+            throw std::invalid_argument("Constraint " + name + " has the name of the objective function");
+        }
+        name_text += name;
+        ends.push_back(name_text.size());
+    }
+
+    col_names.reserve(col_count);
+    row_names.reserve(ends.size() - col_count);
+    for (size_t k = 0, begin = 0; k < ends.size(); begin = ends[k++]){
+        (k < col_count ? col_names : row_names).push_back(std::string_view(name_text.data() + begin, ends[k] - begin));
+    }
+}
+
+void ModelWriter::checkName(const std::string& name) const {
+    bool valid = !name.empty();
+    if (format == Format::MPS){
+        for (size_t k = 0; valid && k < name.size(); k++){
+            valid = name[k] != ' ' && name[k] != '\t' && name[k] != '\n' && name[k] != '\r';
+        }
+    }
+    else{
+        valid = valid && name.size() <= 255 && !(name[0] >= '0' && name[0] <= '9') && name[0] != '.';
+        valid = valid && !((name[0] == 'e' || name[0] == 'E') && name.size() > 1 && name[1] >= '0' && name[1] <= '9'); // Read as the exponent of the coefficient before it
+        for (size_t k = 0; valid && k < name.size(); k++){
+            valid = isLpNameChar(name[k]);
+        }
+    }
+
+    if (!valid){
+        throw std::invalid_argument("Name \"" + name + "\" can not be written in the " + (format == Format::MPS ? "MPS" : "LP") + " format");
+    }
+}
+
+void ModelWriter::writeMps(const SparseMatrix& a, const std::string& objective_row, bool maximize){
+    put("NAME\n");
+    if (maximize){
+        put("OBJSENSE\n    MAX\n");
+    }
+
+    put("ROWS\n N  ");
+    put(objective_row);
+    put('\n');
+    for (uint32_t i = 0; i < a.row_count; i++){
+        put(' ');
+        put(rowType(a.row_lower[i], a.row_upper[i]));
+        put("  ");
+        put(row_names[i]);
+        put('\n');
+    }
+
+    put("COLUMNS\n");
+    bool integer = false; // Inside the integer markers
+    for (uint32_t j = 0; j < a.col_count; j++){
+        bool is_integer = domains[j] == Var::Domaine::INT || (domains[j] == Var::Domaine::BIN && !isBinary(domains[j], a.col_lower[j], a.col_upper[j]));
+        if (is_integer != integer){
+            put(is_integer ? "    MARKER  'MARKER'  'INTORG'\n" : "    MARKER  'MARKER'  'INTEND'\n");
+            integer = is_integer;
+        }
+
+        size_t on_line = 0; // Two row/value pairs per line
+        auto element = [&](std::string_view row, double value){
+            if (on_line == 0){
+                put("    ");
+                put(col_names[j]);
+            }
+            put("  ");
+            put(row);
+            put("  ");
+            put(value, "1e30");
+            if (++on_line == 2){
+                put('\n');
+                on_line = 0;
+            }
+        };
+
+        if (a.objective[j] != 0 || a.start[j] == a.start[j + 1]){ // A column without element is declared by its objective coefficient
+            element(objective_row, a.objective[j]);
+        }
+        for (size_t k = a.start[j]; k < a.start[j + 1]; k++){
+            element(row_names[a.index[k]], a.value[k]);
+        }
+        if (on_line != 0){
+            put('\n');
+        }
+    }
+    if (integer){
+        put("    MARKER  'MARKER'  'INTEND'\n");
+    }
+
+    put("RHS\n");
+    for (uint32_t i = 0; i < a.row_count; i++){
+        double rhs = rowType(a.row_lower[i], a.row_upper[i]) == 'L' ? a.row_upper[i] : a.row_lower[i];
+        if (rhs != 0){
+            put("    RHS  ");
+            put(row_names[i]);
+            put("  ");
+            put(rhs, "1e30");
+            put('\n');
+        }
+    }
+
+    put("RANGES\n");
+    for (uint32_t i = 0; i < a.row_count; i++){ // The G rows with two finite bounds, [lower, lower + range]
+        if (!std::isinf(a.row_lower[i]) && !std::isinf(a.row_upper[i]) && a.row_lower[i] != a.row_upper[i]){
+            put("    RNG  ");
+            put(row_names[i]);
+            put("  ");
+            put(a.row_upper[i] - a.row_lower[i], "1e30");
+            put('\n');
+        }
+    }
+
+    put("BOUNDS\n");
+    for (uint32_t j = 0; j < a.col_count; j++){ // The default bounds are [0, inf)
+        std::string_view name = col_names[j];
+        double lower = a.col_lower[j];
+        double upper = a.col_upper[j];
+        auto bound = [&](const char* type, double value, bool with_value){
+            put(' ');
+            put(type);
+            put(" BND  ");
+            put(name);
+            if (with_value){
+                put("  ");
+                put(value, "1e30");
+            }
+            put('\n');
+        };
+
+        if (isBinary(domains[j], lower, upper)){
+            bound("BV", 0, false);
+        }
+        else if (lower == upper){
+            bound("FX", lower, true);
+        }
+        else if (std::isinf(lower) && lower < 0 && std::isinf(upper) && upper > 0){
+            bound("FR", 0, false);
+        }
+        else{
+            if (lower != 0){
+                if (std::isinf(lower) && lower < 0){
+                    bound("MI", 0, false);
+                }
+                else{
+                    bound("LO", lower, true);
+                }
+            }
+            if (!(std::isinf(upper) && upper > 0)){
+                bound("UP", upper, true);
+                if (lower == 0 && upper < 0){ // A negative UP makes the lower bound -inf when it is 0, set it again
+                    bound("LO", 0, true);
+                }
+            }
+        }
+    }
+
+    put("ENDATA\n");
+}
+
+void ModelWriter::writeLp(const SparseMatrix& a, const std::string& objective_row, bool maximize){
+    put(maximize ? "Maximize" : "Minimize");
+    newLine();
+    put(' ');
+    put(objective_row);
+    put(':');
+    bool first = true;
+    for (uint32_t j = 0; j < a.col_count; j++){
+        if (a.objective[j] != 0){
+            putTerm(a.objective[j], col_names[j], first);
+            first = false;
+        }
+    }
+    if (first && a.col_count != 0){ // Some readers need a term
+        putTerm(0, col_names[0], true);
+    }
+    newLine();
+
+    put("Subject To");
+    newLine();
+    for (uint32_t i = 0; i < a.row_count; i++){
+        double lower = a.row_lower[i];
+        double upper = a.row_upper[i];
+        bool ranged = !std::isinf(lower) && !std::isinf(upper) && lower != upper;
+
+        put(' ');
+        put(row_names[i]);
+        put(':');
+        if (ranged){ // lower <= expression <= upper
+            put(' ');
+            put(lower, "inf");
+            put(" <=");
+        }
+        if (a.start[i] == a.start[i + 1] && a.col_count != 0){
+            putTerm(0, col_names[0], true);
+        }
+        for (size_t k = a.start[i]; k < a.start[i + 1]; k++){
+            putTerm(a.value[k], col_names[a.index[k]], k == a.start[i]);
+        }
+
+        if (lower == upper){
+            put(" = ");
+            put(lower, "inf");
+        }
+        else if (ranged || (std::isinf(lower) && !std::isinf(upper))){
+            put(" <= ");
+            put(upper, "inf");
+        }
+        else{ // Only a lower bound, -inf for a free row
+            put(" >= ");
+            put(lower, "inf");
+        }
+        newLine();
+    }
+
+    put("Bounds");
+    newLine();
+    for (uint32_t j = 0; j < a.col_count; j++){ // The default bounds are [0, inf)
+        std::string_view name = col_names[j];
+        double lower = a.col_lower[j];
+        double upper = a.col_upper[j];
+        bool no_lower = std::isinf(lower) && lower < 0;
+        bool no_upper = std::isinf(upper) && upper > 0;
+        if (isBinary(domains[j], lower, upper) || (lower == 0 && no_upper)){
+            continue;
+        }
+
+        put(' ');
+        if (lower == upper){
+            put(name);
+            put(" = ");
+            put(lower, "inf");
+        }
+        else if (no_lower && no_upper){
+            put(name);
+            put(" free");
+        }
+        else if (no_upper){
+            put(name);
+            put(" >= ");
+            put(lower, "inf");
+        }
+        else{
+            put(lower, "inf");
+            put(" <= ");
+            put(name);
+            put(" <= ");
+            put(upper, "inf");
+        }
+        newLine();
+    }
+
+    for (bool binaries : {false, true}){ // Generals then Binaries, the names separated by blanks
+        bool header = false;
+        for (uint32_t j = 0; j < a.col_count; j++){
+            bool binary = isBinary(domains[j], a.col_lower[j], a.col_upper[j]);
+            if (domains[j] == Var::Domaine::REAL || binary != binaries){
+                continue;
+            }
+            if (!header){
+                put(binaries ? "Binaries" : "Generals");
+                newLine();
+                header = true;
+            }
+            wrapLine();
+            put(' ');
+            put(col_names[j]);
+        }
+        if (header){
+            newLine();
+        }
+    }
+
+    put("End");
+    newLine();
+}
+
+void ModelWriter::putTerm(double coef, std::string_view name, bool first){
+    wrapLine();
+    put(coef < 0 ? " - " : (first ? " " : " + "));
+    double magnitude = std::abs(coef);
+    if (magnitude != 1){
+        put(magnitude, "inf");
+        put(' ');
+    }
+    put(name);
+}
+
+void ModelWriter::newLine(){
+    put('\n');
+    line_start = bytes_written + used;
+}
+
+void ModelWriter::wrapLine(){
+    if (bytes_written + used - line_start > LP_LINE_LENGTH){
+        newLine();
+        put(' ');
+    }
+}
+
+void ModelWriter::put(char c){
+    if (used == buffer.size()){
+        flush();
+    }
+    buffer[used++] = c;
+}
+
+void ModelWriter::put(std::string_view text){
+    if (text.size() > buffer.size() - used){
+        flush();
+        if (text.size() > buffer.size()){ // Longer than the buffer, handed to the stream as is
+            out->write(text.data(), text.size());
+            bytes_written += text.size();
+            return;
+        }
+    }
+    std::memcpy(buffer.data() + used, text.data(), text.size());
+    used += text.size();
+}
+
+void ModelWriter::put(double value, std::string_view infinity){
+    if (std::isinf(value)){
+        if (value < 0){
+            put('-');
+        }
+        put(infinity);
+        return;
+    }
+
+    if (buffer.size() - used < NUMBER_SIZE){
+        flush();
+    }
+    std::to_chars_result result = std::to_chars(buffer.data() + used, buffer.data() + buffer.size(), value);
+    used = result.ptr - buffer.data();
+}
+
+void ModelWriter::flush(){
+    out->write(buffer.data(), used);
+    if (!*out){
+        throw std::runtime_error("Can not write the model");
+    }
+    bytes_written += used;
+    used = 0;
+}
+
+}
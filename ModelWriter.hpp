@@ -0,0 +1,102 @@
+#ifndef _MODELWRITER_HPP
+#define _MODELWRITER_HPP
+
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Model.hpp"
+
+namespace Osi2 {
+
+/*! \brief Writer of the linear part of a Model in the free MPS format or the CPLEX LP format
+
+    The text goes through a large buffer, reused from one write to the next and handed to the stream when it is full : the numbers
+    are formatted in place with std::to_chars (the shortest text that reads back to the same double), and no string is built per
+    row or per term. The coefficients come from the arrays of Model::toCSC for MPS, written column by column as the format asks,
+    and of Model::toCSR for LP, whose constraints are written row by row.
+
+    Only the linear constraints are written, in the order of the model, and a single objective function. Infinite bounds are
+    written as 1e30 in MPS and as inf in LP. The names are checked before anything is written : the free MPS format does not
+    accept blanks, the LP format only accepts the letters, digits and !"#$%&()/,.;?@_`'{}|~, not as first character a digit or a
+    period, and no name starting with e or E followed by a digit (e1, E2x), which the readers take for the exponent of a number.
+    The uniqueness of the names is not checked.
+ */
+class ModelWriter {
+    public:
+        /// Format of the file
+        enum class Format {
+            MPS, ///< Free MPS : ROWS, COLUMNS, RHS, RANGES and BOUNDS sections, integer markers and BV bounds
+            LP ///< CPLEX LP : objective, Subject To, Bounds, Generals and Binaries sections
+        };
+
+        /// \name Constructors
+        //{@
+
+        /// Constructs a writer of a given format
+        ModelWriter(Format format = Format::MPS);
+        //@}
+
+        /// Write the linear constraints, the bounds and the domains of the variables of a model to a file, with the objective function
+        /// of a given name (none if empty). Throws std::invalid_argument if the file can not be opened, the objective function does not
+        /// exist or is not linear, or a name can not be written in the format, and std::runtime_error if the writing fails
+        void write(const std::string& path, const Model& m, const std::string& objective = "");
+
+        /// Write a model to a stream, see write(path, m, objective)
+        void write(std::ostream& out, const Model& m, const std::string& objective = "");
+
+        /// Get the number of bytes of the last model written
+        size_t getBytesWritten() const { return bytes_written; }
+
+    private:
+        static const size_t BUFFER_SIZE = 1 << 22; ///< Size of the buffer, handed to the stream when full
+        static const size_t NUMBER_SIZE = 32; ///< Room kept in the buffer for a number, more than the longest double from std::to_chars
+        static const size_t LP_LINE_LENGTH = 200; ///< The LP lines are cut after this length, the readers limit their length
+
+        /// Copy the names of the columns and of the linear rows into name_text, and check them
+        void collectNames(const Model& m, const std::string& objective_row);
+
+        /// Check that a name can be written in the format, throws std::invalid_argument otherwise
+        void checkName(const std::string& name) const;
+
+        /// Write a problem in the MPS format, from its CSC arrays
+        void writeMps(const SparseMatrix& a, const std::string& objective_row, bool maximize);
+
+        /// Write a problem in the LP format, from its CSR arrays
+        void writeLp(const SparseMatrix& a, const std::string& objective_row, bool maximize);
+
+        /// Write a term of a linear expression in the LP format : the sign (none for a positive first term), the coefficient unless it is 1 and the name
+        void putTerm(double coef, std::string_view name, bool first);
+
+        /// End the current line
+        void newLine();
+
+        /// Start a new line if the current LP line is longer than LP_LINE_LENGTH
+        void wrapLine();
+
+        /// \name Buffered output
+        //{@
+        void put(char c);
+        void put(std::string_view text);
+        /// Write a number, the shortest text that reads back to the same double. The infinities are written as infinity
+        void put(double value, std::string_view infinity);
+        void flush();
+        //@}
+
+        Format format; ///< Format of the file
+        std::ostream* out; ///< Stream being written
+        std::vector<char> buffer; ///< Text not yet handed to the stream, kept between two writes
+        size_t used; ///< Number of bytes of the buffer in use
+        size_t line_start; ///< Value of bytes_written + used at the start of the current line
+        size_t bytes_written; ///< Bytes handed to the stream
+
+        std::string name_text; ///< Names of the columns then of the rows, one after the other : the writing reads them from one block
+        std::vector<std::string_view> col_names; ///< Name of each column, in name_text
+        std::vector<Var::Domaine> domains; ///< Domain of each column
+        std::vector<std::string_view> row_names; ///< Name of each linear constraint, in the order of the model, in name_text
+};
+
+}
+
+#endif // _MODELWRITER_HPP
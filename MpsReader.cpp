@@ -0,0 +1,860 @@
+#include "MpsReader.hpp"
+
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define OSI2_MPS_MMAP
+#endif
+
+#include "Parallel.hpp"
+
+namespace Osi2 {
+
+namespace {
+
+/// Check if a character separates the fields. string_view::find_first_of calls char_traits::find for each character, several times slower on short fields
+inline bool isBlank(char c){
+    return c == ' ' || c == '\t';
+}
+
+/// Remove the blanks at both ends of a field
+std::string_view trim(std::string_view s){
+    size_t begin = 0;
+    size_t end = s.size();
+    while (begin < end && isBlank(s[begin])){
+        ++begin;
+    }
+    while (end > begin && isBlank(s[end - 1])){
+        --end;
+    }
+    return s.substr(begin, end - begin);
+}
+
+/// Get the start of the line after the one at p, or end
+inline const char* nextLine(const char* p, const char* end){
+    const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+    return eol != nullptr ? eol + 1 : end;
+}
+
+/// Remove the end of line of a line
+inline std::string_view lineAt(const char* begin, const char* next){
+    std::string_view ret_val(begin, next - begin);
+    if (!ret_val.empty() && ret_val.back() == '\n'){
+        ret_val.remove_suffix(1);
+    }
+    return ret_val;
+}
+
+#ifdef OSI2_MPS_MMAP
+/// Read-only memory mapping of a file, unmapped by the destructor
+class MappedFile {
+    public:
+        MappedFile(const std::string& path) : data(nullptr), size(0) {
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0){
+                throw std::invalid_argument("Can not open file " + path);
+            }
+            struct stat st;
+            if (::fstat(fd, &st) != 0){
+                ::close(fd);
+                throw std::invalid_argument("Can not read the size of file " + path);
+            }
+            size = st.st_size;
+            if (size != 0){
+                void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (mapped == MAP_FAILED){
+                    ::close(fd);
+                    throw std::invalid_argument("Can not map file " + path);
+                }
+                data = static_cast<const char*>(mapped);
+            }
+            ::close(fd); // The mapping stays valid
+        }
+
+        ~MappedFile(){
+            if (data != nullptr){
+                ::munmap(const_cast<char*>(data), size);
+            }
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        std::string_view text() const { return std::string_view(data, size); }
+
+    private:
+        const char* data; ///< Start of the mapping, nullptr for an empty file
+        size_t size; ///< Size of the file
+};
+#endif
+
+}
+
+uint32_t MpsReader::NameTable::find(std::string_view name) const {
+    if (slots.empty()){
+        return NONE;
+    }
+    uint64_t hash = std::hash<std::string_view>()(name);
+    size_t mask = slots.size() - 1;
+    for (size_t pos = hash & mask; slots[pos] != 0; pos = (pos + 1) & mask){
+        uint32_t number = uint32_t(slots[pos]) - 1;
+        if ((slots[pos] >> 32) == (hash >> 32) && entries[number] == name){
+            return number;
+        }
+    }
+    return NONE;
+}
+
+uint32_t MpsReader::NameTable::insert(std::string_view name, bool& inserted){
+    if (2 * (entries.size() + 1) > slots.size()){ // At most half of the slots are used
+        grow();
+    }
+    uint64_t hash = std::hash<std::string_view>()(name);
+    size_t mask = slots.size() - 1;
+    size_t pos = hash & mask;
+    for (; slots[pos] != 0; pos = (pos + 1) & mask){
+        uint32_t number = uint32_t(slots[pos]) - 1;
+        if ((slots[pos] >> 32) == (hash >> 32) && entries[number] == name){
+            inserted = false;
+            return number;
+        }
+    }
+    entries.emplace_back(name);
+    slots[pos] = (hash & 0xFFFFFFFF00000000) | entries.size();
+    inserted = true;
+    return entries.size() - 1;
+}
+
+void MpsReader::NameTable::clear(){
+    std::vector<std::string>().swap(entries);
+    std::vector<uint64_t>().swap(slots);
+}
+
+void MpsReader::NameTable::grow(){
+    slots.assign(std::max(size_t(1024), 2 * slots.size()), 0);
+    size_t mask = slots.size() - 1;
+    for (size_t i = 0; i < entries.size(); i++){
+        uint64_t hash = std::hash<std::string_view>()(entries[i]);
+        size_t pos = hash & mask;
+        while (slots[pos] != 0){
+            pos = (pos + 1) & mask;
+        }
+        slots[pos] = (hash & 0xFFFFFFFF00000000) | (i + 1);
+    }
+}
+
+MpsReader::MpsReader(Format format) : format(format), section(Section::NONE), line_number(0), objective_constant(0), maximize(false),
+                                      row_count(0), col_count(0), element_count(0), integer_block(false) {}
+
+void MpsReader::read(const std::string& path, Model& m){
+#ifdef OSI2_MPS_MMAP
+    MappedFile file(path);
+    readText(file.text(), m);
+#else
+    std::ifstream in(path, std::ios::binary);
+    if (!in){
+        throw std::invalid_argument("Can not open file " + path);
+    }
+    read(in, m);
+#endif
+}
+
+void MpsReader::readText(std::string_view text, Model& m){
+    reset();
+
+    const char* pos = text.data();
+    const char* end = text.data() + text.size();
+    while (pos != end){
+        const char* next = nextLine(pos, end);
+        parseLine(lineAt(pos, next));
+        pos = next;
+        if (section == Section::COLUMNS){ // The bulk of the file, parsed in parallel up to the header of the next section
+            pos = parseColumns(pos, end);
+        }
+    }
+
+    finish(m);
+}
+
+void MpsReader::read(std::istream& in, Model& m){
+    reset();
+
+    std::vector<char> buffer(BUFFER_SIZE);
+    size_t kept = 0; // Bytes of the incomplete last line of the previous block, moved to the front of the buffer
+    while (true){
+        in.read(buffer.data() + kept, buffer.size() - kept);
+        size_t end = kept + in.gcount();
+        if (end == kept){ // End of the stream, the last line may have no end of line
+            if (kept != 0){
+                parseLine(std::string_view(buffer.data(), kept));
+            }
+            break;
+        }
+
+        const char* begin = buffer.data();
+        const char* stop = buffer.data() + end;
+        for (const char* eol; (eol = static_cast<const char*>(std::memchr(begin, '\n', stop - begin))) != nullptr; begin = eol + 1){
+            parseLine(std::string_view(begin, eol - begin));
+        }
+
+        kept = stop - begin;
+        std::memmove(buffer.data(), begin, kept);
+        if (kept == buffer.size()){ // A line longer than the buffer
+            buffer.resize(2 * buffer.size());
+        }
+    }
+
+    finish(m);
+}
+
+void MpsReader::reset(){
+    releaseTables();
+    section = Section::NONE;
+    line_number = 0;
+    problem_name.clear();
+    objective_name.clear();
+    objective_constant = 0;
+    maximize = false;
+    row_count = 0;
+    col_count = 0;
+    element_count = 0;
+    integer_block = false;
+}
+
+void MpsReader::finish(Model& m){
+    mergeColumns(); // In case the file ends in the COLUMNS section
+    if (section != Section::ENDATA){
+        error("The file ends without ENDATA");
+    }
+
+    element_count = triplet_values.size();
+    build(m);
+    releaseTables();
+}
+
+void MpsReader::releaseTables(){
+    row_names.clear();
+    std::vector<uint32_t>().swap(row_of_name);
+    std::vector<char>().swap(row_types);
+    std::vector<double>().swap(rhs);
+    std::vector<double>().swap(ranges);
+    col_names.clear();
+    std::vector<Var::Domaine>().swap(domains);
+    std::vector<double>().swap(lower);
+    std::vector<double>().swap(upper);
+    std::vector<double>().swap(objective);
+    std::vector<ColumnsPart>().swap(parts);
+    std::vector<uint32_t>().swap(triplet_rows);
+    std::vector<uint32_t>().swap(triplet_cols);
+    std::vector<double>().swap(triplet_values);
+}
+
+void MpsReader::parseLine(std::string_view line){
+    ++line_number;
+    if (!line.empty() && line.back() == '\r'){
+        line.remove_suffix(1);
+    }
+    if (line.empty() || line[0] == '*'){ // Comment
+        return;
+    }
+    if (line[0] != ' ' && line[0] != '\t'){ // Section headers start at the first column, data lines with a blank
+        parseHeader(line);
+        return;
+    }
+
+    if (section == Section::OBJSENSE){
+        parseSense(trim(line));
+        return;
+    }
+
+    Fields fields;
+    size_t count = splitFields(line, fields);
+    if (count == 0){ // Blank line
+        return;
+    }
+    if (count > 6){
+        error("More than 6 fields");
+    }
+
+    switch (section){
+        case Section::ROWS:
+            parseRow(fields);
+            break;
+        case Section::COLUMNS:
+            parseColumn(fields, parts.back(), line_number);
+            break;
+        case Section::RHS:
+            parseRhs(fields);
+            break;
+        case Section::RANGES:
+            parseRange(fields);
+            break;
+        case Section::BOUNDS:
+            parseBound(fields);
+            break;
+        default:
+            error("Data line outside of the ROWS, COLUMNS, RHS, RANGES and BOUNDS sections");
+    }
+}
+
+void MpsReader::parseSense(std::string_view sense){
+    if (sense == "MAX" || sense == "MAXIMIZE"){
+        maximize = true;
+    }
+    else if (sense == "MIN" || sense == "MINIMIZE"){
+        maximize = false;
+    }
+    else{
+        error("Unknown objective sense " + std::string(sense));
+    }
+}
+
+void MpsReader::parseHeader(std::string_view line){
+    size_t end = 0;
+    while (end < line.size() && !isBlank(line[end])){
+        ++end;
+    }
+    std::string_view word = line.substr(0, end);
+    std::string_view rest = trim(line.substr(end));
+
+    if (section == Section::ENDATA){
+        error("Section " + std::string(word) + " after ENDATA");
+    }
+    if (section == Section::COLUMNS){ // The columns are needed by the next sections
+        mergeColumns();
+    }
+
+    if (word == "NAME"){
+        section = Section::NAME;
+        problem_name = std::string(rest);
+    }
+    else if (word == "ROWS"){
+        section = Section::ROWS;
+    }
+    else if (word == "COLUMNS"){ // Read by the stream parser into a single part, the parallel parser makes its own parts
+        section = Section::COLUMNS;
+        parts.assign(1, ColumnsPart());
+        parts[0].integer_state = integer_block ? 1 : 0;
+    }
+    else if (word == "RHS"){
+        section = Section::RHS;
+    }
+    else if (word == "RANGES"){
+        section = Section::RANGES;
+    }
+    else if (word == "BOUNDS"){
+        section = Section::BOUNDS;
+    }
+    else if (word == "OBJSENSE"){ // The sense is on the next line, or on the same one for some writers
+        section = Section::OBJSENSE;
+        if (!rest.empty()){
+            parseSense(rest);
+        }
+    }
+    else if (word == "ENDATA"){
+        section = Section::ENDATA;
+    }
+    else{
+        error("Unsupported section " + std::string(word));
+    }
+}
+
+size_t MpsReader::splitFields(std::string_view line, Fields& fields) const {
+    size_t ret_val = 0;
+
+    if (format == Format::FIXED){
+        static const size_t begins[6] = { 1, 4, 14, 24, 39, 49 };
+        static const size_t ends[6] = { 3, 12, 22, 36, 47, 61 };
+        for (size_t k = 0; k < 6; k++){
+            fields[k] = begins[k] < line.size() ? trim(line.substr(begins[k], ends[k] - begins[k])) : std::string_view();
+            if (!fields[k].empty()){
+                ret_val = k + 1;
+            }
+        }
+        return ret_val;
+    }
+
+    std::string_view tokens[6];
+    const char* pos = line.data();
+    const char* end = line.data() + line.size();
+    while (true){
+        while (pos != end && isBlank(*pos)){
+            ++pos;
+        }
+        if (pos == end){
+            break;
+        }
+        if (ret_val == 6){ // Too many fields, the caller reports it
+            return 7;
+        }
+        const char* begin = pos;
+        while (pos != end && !isBlank(*pos)){
+            ++pos;
+        }
+        tokens[ret_val++] = std::string_view(begin, pos - begin);
+    }
+
+    size_t first = 0; // Fixed format field of the first token
+    switch (section){
+        case Section::COLUMNS: // Column, then row/value pairs
+            first = 1;
+            break;
+        case Section::RHS:
+        case Section::RANGES: // The set name is optional : without it there is an even number of tokens
+            first = ret_val % 2 == 0 ? 2 : 1;
+            break;
+        case Section::BOUNDS: // Type, optional set name, column, value for the types that need one
+            if (ret_val == 2 || (ret_val == 3 && tokens[0] != "FR" && tokens[0] != "MI" && tokens[0] != "PL" && tokens[0] != "BV")){
+                fields = Fields{ tokens[0], std::string_view(), tokens[1], tokens[2], std::string_view(), std::string_view() };
+                return ret_val;
+            }
+            break;
+        default:
+            break;
+    }
+    if (first + ret_val > 6){ // The tokens do not fit in the fields left after the skipped ones
+        return 7;
+    }
+    for (size_t k = 0; k < 6; k++){
+        fields[k] = k >= first && k - first < ret_val ? tokens[k - first] : std::string_view();
+    }
+
+    return ret_val;
+}
+
+void MpsReader::parseRow(const Fields& fields){
+    if (fields[1].empty()){
+        error("Row without name");
+    }
+
+    uint32_t row;
+    if (fields[0] == "N"){ // The first N row is the objective
+        row = objective_name.empty() ? OBJECTIVE : IGNORED;
+        if (objective_name.empty()){
+            objective_name = std::string(fields[1]);
+        }
+    }
+    else if (fields[0] == "E" || fields[0] == "L" || fields[0] == "G"){
+        row = row_count++;
+        row_types.push_back(fields[0][0]);
+        rhs.push_back(0);
+        ranges.push_back(std::numeric_limits<double>::quiet_NaN());
+    }
+    else{
+        error("Unknown row type " + std::string(fields[0]));
+    }
+
+    bool inserted;
+    row_names.insert(fields[1], inserted);
+    if (!inserted){
+        error("Duplicate row " + std::string(fields[1]));
+    }
+    row_of_name.push_back(row);
+}
+
+void MpsReader::parseColumn(const Fields& fields, ColumnsPart& part, size_t line) const {
+    if (fields[2] == "'MARKER'"){ // Integer markers, the marker type is in the fifth field (fixed) or the third token (free)
+        std::string_view marker = fields[4].empty() ? fields[3] : fields[4];
+        if (marker == "'INTORG'"){
+            part.integer_state = 1;
+        }
+        else if (marker == "'INTEND'"){
+            part.integer_state = 0;
+        }
+        else{
+            error("Unknown marker " + std::string(marker), line);
+        }
+        return;
+    }
+
+    if (fields[1].empty()){
+        error("Column without name", line);
+    }
+
+    uint32_t col = part.last_column;
+    if (col >= part.names.size() || part.names.names()[col] != fields[1]){ // Not the same column as the previous line, look it up or create it
+        bool inserted;
+        col = part.names.insert(fields[1], inserted);
+        if (inserted){
+            part.integer.push_back(part.integer_state);
+            part.objective.push_back(0);
+        }
+        part.last_column = col;
+    }
+
+    for (size_t k = 2; k < 6; k += 2){ // One or two row/value pairs
+        if (fields[k].empty()){
+            continue;
+        }
+        if (fields[k + 1].empty()){
+            error("No value for row " + std::string(fields[k]), line);
+        }
+        uint32_t row = rowIndex(fields[k], line);
+        double value = parseNumber(fields[k + 1], line);
+        if (row == OBJECTIVE){
+            part.objective[col] += value;
+        }
+        else if (row != IGNORED){
+            part.rows.push_back(row);
+            part.cols.push_back(col);
+            part.values.push_back(value);
+        }
+    }
+}
+
+const char* MpsReader::parseColumns(const char* begin, const char* end){
+    size_t thread_count = threadCountFor(end - begin, MIN_BYTES_PER_THREAD);
+
+    std::vector<const char*> bounds(thread_count + 1, end); // Chunks of about the same size, cut at line boundaries
+    bounds[0] = begin;
+    for (size_t t = 1; t < thread_count; t++){
+        bounds[t] = std::max(bounds[t - 1], nextLine(begin + (end - begin) * t / thread_count, end));
+    }
+
+    std::vector<size_t> lines(thread_count, 0); // Lines of each chunk before the end of the section
+    std::vector<const char*> next_section(thread_count, nullptr); // First section header of each chunk
+    parallelFor(thread_count, [&](size_t t){
+        for (const char* p = bounds[t]; p != bounds[t + 1]; p = nextLine(p, bounds[t + 1])){
+            if (!isBlank(*p) && *p != '*' && *p != '\n' && *p != '\r'){
+                next_section[t] = p;
+                break;
+            }
+            ++lines[t];
+        }
+    });
+
+    size_t chunk_count = thread_count;
+    for (size_t t = 0; t < thread_count; t++){ // The section ends at the first header, the chunks after it are not part of it
+        if (next_section[t] != nullptr){
+            chunk_count = t + 1;
+            bounds[t + 1] = next_section[t];
+            break;
+        }
+    }
+
+    std::vector<size_t> first_line(chunk_count, line_number); // Number of the line before each chunk, for the errors
+    for (size_t t = 1; t < chunk_count; t++){
+        first_line[t] = first_line[t - 1] + lines[t - 1];
+    }
+
+    parts.assign(chunk_count, ColumnsPart());
+    parts[0].integer_state = integer_block ? 1 : 0;
+    parallelFor(chunk_count, [&](size_t t){
+        parseColumnsChunk(bounds[t], bounds[t + 1], first_line[t], parts[t]);
+    });
+
+    line_number = first_line[chunk_count - 1] + lines[chunk_count - 1];
+    mergeColumns();
+
+    return bounds[chunk_count];
+}
+
+void MpsReader::parseColumnsChunk(const char* begin, const char* end, size_t first_line, ColumnsPart& part) const {
+    size_t line = first_line;
+    try{
+        for (const char* p = begin; p != end;){
+            const char* next = nextLine(p, end);
+            std::string_view text = lineAt(p, next);
+            p = next;
+            ++line;
+
+            if (!text.empty() && text.back() == '\r'){
+                text.remove_suffix(1);
+            }
+            if (text.empty() || text[0] == '*'){ // Comment
+                continue;
+            }
+
+            Fields fields;
+            size_t count = splitFields(text, fields);
+            if (count > 6){
+                error("More than 6 fields", line);
+            }
+            if (count != 0){
+                parseColumn(fields, part, line);
+            }
+        }
+    }
+    catch (const std::invalid_argument& e){ // Thrown again by mergeColumns, in file order
+        part.error = e.what();
+    }
+}
+
+void MpsReader::mergeColumns(){
+    if (parts.empty()){
+        return;
+    }
+    for (const auto& part : parts){
+        if (!part.error.empty()){
+            std::string message = part.error;
+            parts.clear();
+            throw std::invalid_argument(message);
+        }
+    }
+
+    std::vector<std::vector<uint32_t>> global(parts.size()); // Column of the problem of each column of each part, empty if they are the same
+    std::vector<size_t> offsets(parts.size() + 1, triplet_values.size()); // Position of the elements of each part in the triplets
+    for (size_t k = 0; k < parts.size(); k++){
+        ColumnsPart& part = parts[k];
+        char start_state = integer_block ? 1 : 0; // Integer state at the start of the chunk, the end of the previous one
+
+        bool same_numbers = col_names.size() == 0; // The first part of the first COLUMNS section numbers the columns as the problem
+        if (same_numbers){
+            col_names = std::move(part.names);
+        }
+        else{
+            global[k].resize(part.names.size());
+        }
+
+        for (size_t i = 0; i < part.integer.size(); i++){
+            uint32_t col = i;
+            bool inserted = same_numbers;
+            if (!same_numbers){
+                col = col_names.insert(part.names.names()[i], inserted);
+                global[k][i] = col;
+            }
+            if (inserted){
+                char state = part.integer[i] == ColumnsPart::INHERIT ? start_state : part.integer[i];
+                domains.push_back(state == 1 ? Var::Domaine::INT : Var::Domaine::REAL);
+                lower.push_back(0);
+                upper.push_back(std::numeric_limits<double>::infinity());
+                objective.push_back(0);
+            }
+            objective[col] += part.objective[i];
+        }
+        part.names.clear();
+
+        if (part.integer_state != ColumnsPart::INHERIT){
+            integer_block = part.integer_state == 1;
+        }
+        offsets[k + 1] = offsets[k] + part.values.size();
+    }
+    col_count = col_names.size();
+
+    if (parts.size() == 1 && triplet_values.empty() && global[0].empty()){ // Single part, as read from a stream : take its arrays
+        triplet_rows.swap(parts[0].rows);
+        triplet_cols.swap(parts[0].cols);
+        triplet_values.swap(parts[0].values);
+    }
+    else{
+        triplet_rows.resize(offsets.back());
+        triplet_cols.resize(offsets.back());
+        triplet_values.resize(offsets.back());
+        parallelFor(parts.size(), [&](size_t k){ // Each part copies its elements at its place, in file order
+            const ColumnsPart& part = parts[k];
+            for (size_t e = 0; e < part.values.size(); e++){
+                triplet_rows[offsets[k] + e] = part.rows[e];
+                triplet_cols[offsets[k] + e] = global[k].empty() ? part.cols[e] : global[k][part.cols[e]];
+                triplet_values[offsets[k] + e] = part.values[e];
+            }
+        });
+    }
+
+    parts.clear();
+}
+
+void MpsReader::parseRhs(const Fields& fields){
+    for (size_t k = 2; k < 6; k += 2){
+        if (fields[k].empty()){
+            continue;
+        }
+        uint32_t row = rowIndex(fields[k], line_number);
+        double value = parseNumber(fields[k + 1], line_number);
+        if (row == OBJECTIVE){ // The RHS of the objective is the opposite of its constant
+            objective_constant = -value;
+        }
+        else if (row != IGNORED){
+            rhs[row] = value;
+        }
+    }
+}
+
+void MpsReader::parseRange(const Fields& fields){
+    for (size_t k = 2; k < 6; k += 2){
+        if (fields[k].empty()){
+            continue;
+        }
+        uint32_t row = rowIndex(fields[k], line_number);
+        double value = parseNumber(fields[k + 1], line_number);
+        if (row == OBJECTIVE || row == IGNORED){
+            error("Range on the N row " + std::string(fields[k]));
+        }
+        ranges[row] = value;
+    }
+}
+
+void MpsReader::parseBound(const Fields& fields){
+    const double inf = std::numeric_limits<double>::infinity();
+    std::string_view type = fields[0];
+    uint32_t col = columnIndex(fields[2]);
+
+    bool needs_value = type == "UP" || type == "LO" || type == "FX" || type == "LI" || type == "UI";
+    if (needs_value && fields[3].empty()){
+        error("No value for the " + std::string(type) + " bound of column " + std::string(fields[2]));
+    }
+    double value = fields[3].empty() ? 0 : parseNumber(fields[3], line_number);
+
+    if (type == "UP" || type == "UI"){
+        upper[col] = value;
+        if (value < 0 && lower[col] == 0){ // Usual convention : a negative upper bound frees the default lower bound
+            lower[col] = -inf;
+        }
+    }
+    else if (type == "LO" || type == "LI"){
+        lower[col] = value;
+    }
+    else if (type == "FX"){
+        lower[col] = value;
+        upper[col] = value;
+    }
+    else if (type == "FR"){
+        lower[col] = -inf;
+        upper[col] = inf;
+    }
+    else if (type == "MI"){
+        lower[col] = -inf;
+    }
+    else if (type == "PL"){
+        upper[col] = inf;
+    }
+    else if (type == "BV"){
+        domains[col] = Var::Domaine::BIN;
+        lower[col] = 0;
+        upper[col] = 1;
+    }
+    else{
+        error("Unsupported bound type " + std::string(type));
+    }
+
+    if (type == "LI" || type == "UI"){
+        domains[col] = Var::Domaine::INT;
+    }
+}
+
+uint32_t MpsReader::rowIndex(std::string_view name, size_t line) const {
+    uint32_t number = row_names.find(name);
+    if (number == NameTable::NONE){
+        error("Unknown row " + std::string(name), line);
+    }
+    return row_of_name[number];
+}
+
+uint32_t MpsReader::columnIndex(std::string_view name) const {
+    uint32_t number = col_names.find(name);
+    if (number == NameTable::NONE){
+        error("Unknown column " + std::string(name));
+    }
+    return number;
+}
+
+double MpsReader::parseNumber(std::string_view field, size_t line){
+    const char* begin = field.data();
+    const char* end = field.data() + field.size();
+    if (begin != end && *begin == '+'){ // Not accepted by from_chars
+        ++begin;
+    }
+
+    double ret_val = 0;
+    std::from_chars_result result = std::from_chars(begin, end, ret_val);
+    if (result.ec != std::errc() || result.ptr != end){
+        error("Invalid number " + std::string(field), line);
+    }
+
+    if (ret_val >= 1e30){
+        ret_val = std::numeric_limits<double>::infinity();
+    }
+    else if (ret_val <= -1e30){
+        ret_val = -std::numeric_limits<double>::infinity();
+    }
+
+    return ret_val;
+}
+
+void MpsReader::error(const std::string& message) const {
+    error(message, line_number);
+}
+
+void MpsReader::error(const std::string& message, size_t line){
+    throw std::invalid_argument("MPS line " + std::to_string(line) + " : " + message);
+}
+
+void MpsReader::build(Model& m){
+    const double inf = std::numeric_limits<double>::infinity();
+
+    std::vector<double> row_lower(row_count);
+    std::vector<double> row_upper(row_count);
+    for (size_t i = 0; i < row_count; i++){
+        double r = rhs[i];
+        row_lower[i] = row_types[i] == 'L' ? -inf : r;
+        row_upper[i] = row_types[i] == 'G' ? inf : r;
+        if (!std::isnan(ranges[i])){ // [rhs - |R|, rhs] for L rows, [rhs, rhs + |R|] for G rows, and on the side of the sign of R for E rows
+            double range = ranges[i];
+            if (row_types[i] == 'L' || (row_types[i] == 'E' && range < 0)){
+                row_lower[i] = r - std::fabs(range);
+            }
+            else{
+                row_upper[i] = r + std::fabs(range);
+            }
+        }
+    }
+
+    std::vector<std::string> constraint_names; // Names of the E, L and G rows
+    constraint_names.reserve(row_count);
+    for (size_t k = 0; k < row_names.size(); k++){
+        if (row_of_name[k] != OBJECTIVE && row_of_name[k] != IGNORED){
+            constraint_names.push_back(std::move(row_names.names()[k]));
+        }
+    }
+
+    if (!objective_name.empty() && m.hasObjectiveFun(objective_name)){ // The names are checked before the model is modified
+        throw std::invalid_argument("MPS row " + objective_name + " : the model already has an objective function of this name");
+    }
+    for (const auto& name : constraint_names){
+        if (m.hasConstraint(name)){
+            throw std::invalid_argument("MPS row " + name + " : the model already has a constraint of this name");
+        }
+    }
+    for (size_t j = 0; j < col_count; j++){
+        if (m.hasVariable(col_names.names()[j])){
+            throw std::invalid_argument("MPS column " + col_names.names()[j] + " : the model already has a variable of this name");
+        }
+    }
+
+    uint32_t offset = m.varsIteratorEnd() - m.varsIteratorBegin(); // The columns follow the variables already in the model
+    for (size_t j = 0; j < col_count; j++){
+        m.addVariable(col_names.names()[j], Range(lower[j], upper[j]), domains[j]);
+    }
+    if (offset != 0){
+        for (auto& c : triplet_cols){
+            c += offset;
+        }
+    }
+
+    DCSRMatrix matrix = DCSRMatrix::fromTriplets(triplet_rows, triplet_cols, triplet_values, row_count, offset + col_count);
+    std::vector<uint32_t>().swap(triplet_rows); // The matrix holds them now
+    std::vector<uint32_t>().swap(triplet_cols);
+    std::vector<double>().swap(triplet_values);
+
+    m.importRows(matrix, row_lower, row_upper, &constraint_names); // Unlike fromMatrix, passes the errors on
+
+    if (!objective_name.empty()){
+        PackedVector coefs;
+        for (size_t j = 0; j < col_count; j++){
+            if (objective[j] != 0){
+                coefs.append(offset + j, objective[j]);
+            }
+        }
+        m.addObjectiveFun(objective_name, LinearExpr(coefs, m), maximize ? Objective::Type::MAXIMIZE : Objective::Type::MINIMIZE);
+    }
+}
+
+}
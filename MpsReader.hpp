@@ -0,0 +1,227 @@
+#ifndef _MPSREADER_HPP
+#define _MPSREADER_HPP
+
+#include <array>
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Model.hpp"
+
+namespace Osi2 {
+
+/*! \brief Reader of linear problems in the MPS format, fixed or free
+
+    The file is parsed line by line in place : the fields are views on the text, the numbers are parsed with std::from_chars, and a
+    string is only built when a row or a column is created. The COLUMNS section is kept as (row, column, value) triplets, turned
+    into a DCSRMatrix with fromTriplets and imported in bulk with Model::importRows.
+
+    read(path) maps the file in memory and parses the COLUMNS section, which holds nearly all the file, on threadCount() threads :
+    the section is cut in chunks at line boundaries, each chunk gets its own column table and triplets, and the chunks are merged
+    in file order, so the model does not depend on the number of threads. A stream is read in large blocks on a single thread.
+
+    Supports the N, E, L and G rows, RHS, RANGES, the UP, LO, FX, FR, MI, PL, BV, LI and UI bounds, the integer markers and the
+    OBJSENSE section. The first N row is the objective, the other ones are ignored. Numbers of absolute value at least 1e30 are infinite.
+    In the fixed format the fields are read at their columns (2-3, 5-12, 15-22, 25-36, 40-47 and 50-61), so names may hold spaces.
+ */
+class MpsReader {
+    public:
+        /// Layout of the fields of a line
+        enum class Format {
+            FREE, ///< Fields separated by blanks, names without spaces
+            FIXED ///< Fields at fixed columns
+        };
+
+        /// \name Constructors
+        //{@
+
+        /// Constructs a reader of a given format
+        MpsReader(Format format = Format::FREE);
+        //@}
+
+        /// Read the problem of a file and add it to a model : a variable per column, a linear constraint per row and the objective function.
+        /// The file is mapped in memory and its COLUMNS section parsed in parallel (read through a stream where mmap is not available).
+        /// Throws std::invalid_argument if the file can not be opened, is not valid MPS, or names a row, a column or the objective function
+        /// like a constraint, a variable or an objective function already in the model, in which case the model is not modified
+        void read(const std::string& path, Model& m);
+
+        /// Read the problem from text in memory and add it to a model, see read(path, m)
+        void readText(std::string_view text, Model& m);
+
+        /// Read the problem from a stream and add it to a model, see read(path, m)
+        void read(std::istream& in, Model& m);
+
+        /// \name Getters
+        //{@
+
+        /// Get the name of the last problem read
+        const std::string& getProblemName() const { return problem_name; }
+
+        /// Get the name of the objective function of the last problem read (the first N row)
+        const std::string& getObjectiveName() const { return objective_name; }
+
+        /// Get the constant of the objective function of the last problem read, opposite of its RHS. The Model does not store it
+        double getObjectiveConstant() const { return objective_constant; }
+
+        /// Get the number of rows of the last problem read, the objective excluded
+        size_t getRowCount() const { return row_count; }
+
+        /// Get the number of columns of the last problem read
+        size_t getColumnCount() const { return col_count; }
+
+        /// Get the number of elements in the COLUMNS section of the last problem read, objective excluded
+        size_t getElementCount() const { return element_count; }
+        //@}
+
+    private:
+        /*! \brief Hash table of the row or column names, numbered in insertion order
+
+            Open addressing with linear probing : a slot holds the upper half of the hash of a name and its number + 1, so a lookup
+            reads one slot and compares one name, where std::unordered_map follows a chain of nodes.
+         */
+        class NameTable {
+            public:
+                static const uint32_t NONE = UINT32_MAX; ///< Number returned by find for the names not in the table
+
+                /// Get the number of a name, NONE if it is not in the table
+                uint32_t find(std::string_view name) const;
+
+                /// Add a name and return its number. If the name is already in the table, returns its number and sets inserted to false
+                uint32_t insert(std::string_view name, bool& inserted);
+
+                /// Get the names, in insertion order
+                std::vector<std::string>& names() { return entries; }
+
+                /// Get the number of names
+                size_t size() const { return entries.size(); }
+
+                /// Remove all the names and free the memory
+                void clear();
+
+            private:
+                /// Double the number of slots and insert the names again
+                void grow();
+
+                std::vector<std::string> entries; ///< Names, in insertion order
+                std::vector<uint64_t> slots; ///< 0 if empty, otherwise the upper half of the hash of a name and its number + 1
+        };
+
+        /// Columns and elements read from a chunk of the COLUMNS section, the columns being numbered in the chunk
+        struct ColumnsPart {
+            static const char INHERIT = 2; ///< Integer state of the columns met before the first marker of a chunk
+
+            NameTable names; ///< Names of the columns met in the chunk
+            std::vector<char> integer; ///< Integer state of each column when it was met : 0, 1 or INHERIT
+            std::vector<double> objective; ///< Objective coefficient of each column
+            std::vector<uint32_t> rows; ///< Row of each element
+            std::vector<uint32_t> cols; ///< Column of each element, numbered in the chunk
+            std::vector<double> values; ///< Value of each element
+            char integer_state = INHERIT; ///< 1 between the INTORG and INTEND markers, INHERIT until the chunk meets a marker
+            uint32_t last_column = UINT32_MAX; ///< Column of the previous line, the lines of a column usually follow each other
+            std::string error; ///< Message of the first error of the chunk, empty if none
+        };
+
+        /// Sections of the file
+        enum class Section { NONE, NAME, ROWS, COLUMNS, RHS, RANGES, BOUNDS, OBJSENSE, ENDATA };
+
+        typedef std::array<std::string_view, 6> Fields; ///< The six fields of a data line, empty when absent
+
+        static const size_t BUFFER_SIZE = 1 << 22; ///< Size of the blocks read from the stream
+        static const size_t MIN_BYTES_PER_THREAD = 1 << 22; ///< Below this size of COLUMNS section per thread, the parsing uses less threads
+        static const uint32_t OBJECTIVE = UINT32_MAX; ///< Row of the objective in row_of_name
+        static const uint32_t IGNORED = UINT32_MAX - 1; ///< Row of the other N rows in row_of_name
+
+        /// Forget the previous problem
+        void reset();
+
+        /// Check the end of the file and add the problem to the model
+        void finish(Model& m);
+
+        /// Free the name tables and the triplets, once they are in the model
+        void releaseTables();
+
+        /// Parse the COLUMNS section starting at begin in parallel, up to the next section or end. Returns the start of the next section
+        const char* parseColumns(const char* begin, const char* end);
+
+        /// Parse the lines of a chunk of the COLUMNS section into a part. first_line is the number of the line before the chunk. Does not throw, the error is kept in the part
+        void parseColumnsChunk(const char* begin, const char* end, size_t first_line, ColumnsPart& part) const;
+
+        /// Merge the parts of the COLUMNS section into the columns and triplets of the problem, in order. Throws the first error of the parts
+        void mergeColumns();
+
+        /// Parse a line, without its end of line
+        void parseLine(std::string_view line);
+
+        /// Parse a section header line
+        void parseHeader(std::string_view line);
+
+        /// Parse the objective sense, from the OBJSENSE header line or the line after it. Throws if it is not MIN, MINIMIZE, MAX or MAXIMIZE
+        void parseSense(std::string_view sense);
+
+        /// Split a data line into its fields, the fields of the free format being moved to their fixed format position.
+        /// Returns the number of fields, more than 6 if the line has too many
+        size_t splitFields(std::string_view line, Fields& fields) const;
+
+        /// \name Section parsers, given the fields of a data line
+        //{@
+        void parseRow(const Fields& fields);
+        void parseColumn(const Fields& fields, ColumnsPart& part, size_t line) const;
+        void parseRhs(const Fields& fields);
+        void parseRange(const Fields& fields);
+        void parseBound(const Fields& fields);
+        //@}
+
+        /// Get the index of a row, throws if it was not declared. line is the line reported in the error
+        uint32_t rowIndex(std::string_view name, size_t line) const;
+
+        /// Get the index of a column, throws if it was not declared in COLUMNS
+        uint32_t columnIndex(std::string_view name) const;
+
+        /// Parse a number, throws if the field is not a number. line is the line reported in the error
+        static double parseNumber(std::string_view field, size_t line);
+
+        /// Throw a std::invalid_argument that gives the current line
+        [[noreturn]] void error(const std::string& message) const;
+
+        /// Throw a std::invalid_argument that gives a line
+        [[noreturn]] static void error(const std::string& message, size_t line);
+
+        /// Add the variables, the constraints and the objective function to the model
+        void build(Model& m);
+
+        Format format; ///< Format of the fields
+        Section section; ///< Section being read
+        size_t line_number; ///< Number of the line being read, from 1
+
+        std::string problem_name; ///< Name of the problem, from the NAME section
+        std::string objective_name; ///< Name of the first N row
+        double objective_constant; ///< Opposite of the RHS of the objective
+        bool maximize; ///< True if OBJSENSE is MAX
+        size_t row_count; ///< Number of rows, N rows excluded
+        size_t col_count; ///< Number of columns
+        size_t element_count; ///< Number of elements of the matrix
+
+        NameTable row_names; ///< Names of the rows, N rows included
+        std::vector<uint32_t> row_of_name; ///< Row of each name of row_names, OBJECTIVE or IGNORED for the N rows
+        std::vector<char> row_types; ///< Type of each row : E, L or G
+        std::vector<double> rhs; ///< Right hand side of each row
+        std::vector<double> ranges; ///< Range of each row, NaN if it has none
+
+        NameTable col_names; ///< Names of the columns, numbered as the columns
+        std::vector<Var::Domaine> domains; ///< Domain of each column
+        std::vector<double> lower; ///< Lower bound of each column
+        std::vector<double> upper; ///< Upper bound of each column
+        std::vector<double> objective; ///< Objective coefficient of each column
+        std::vector<ColumnsPart> parts; ///< Chunks of the COLUMNS section being read, merged at the end of the section
+        bool integer_block; ///< True between the INTORG and INTEND markers, at the end of the merged parts
+
+        std::vector<uint32_t> triplet_rows; ///< Row of each element
+        std::vector<uint32_t> triplet_cols; ///< Column of each element
+        std::vector<double> triplet_values; ///< Value of each element
+};
+
+}
+
+#endif // _MPSREADER_HPP
@@ -3,46 +3,138 @@
 #include <iostream>
 
 #include <algorithm>
+#include <stdexcept>
+#include <limits>
+#include <cmath>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
 namespace Osi2 {
 
+constexpr double PackedVector::ZERO_THRESHOLD;
+
 PackedVector::PackedVector(){}
 
-PackedVector::PackedVector(const PackedVector& other) : values(other.values) {}
+PackedVector::PackedVector(const PackedVector& other) : index_array(other.index_array), value_array(other.value_array), sealed(other.sealed) {}
 
-PackedVector::PackedVector(PackedVector&& other){
-    std::swap(values, other.values);
+PackedVector::PackedVector(PackedVector&& other) : index_array(std::move(other.index_array)), value_array(std::move(other.value_array)), sealed(other.sealed) {
+    other.clear();
 }
 
 PackedVector& PackedVector::operator=(const PackedVector& other){
-    values = other.values;
+    index_array = other.index_array;
+    value_array = other.value_array;
+    sealed = other.sealed;
 
     return (*this);
 }
 
+PackedVector& PackedVector::operator=(PackedVector&& other){
+    index_array.swap(other.index_array);
+    value_array.swap(other.value_array);
+    std::swap(sealed, other.sealed);
+
+    return (*this);
+}
+
+size_t PackedVector::lowerBound(uint32_t index) const {
+    ensureSealed();
+    return std::lower_bound(std::begin(index_array), std::end(index_array), index) - std::begin(index_array);
+}
+
 bool PackedVector::insert(uint32_t index, double value){
-    const double threshold = 0.01; //TODO Change that
     bool ret_val = false;
-    if ( std::abs(value) > threshold){
-        auto response = values.insert(std::make_pair(index, value));
-        ret_val = response.second;
+    if ( std::abs(value) > ZERO_THRESHOLD){
+        ensureSealed();
+        if (index_array.empty() || index_array.back() < index){ // Fast path, the elements are inserted in increasing index order
+            index_array.push_back(index);
+            value_array.push_back(value);
+            ret_val = true;
+        }
+        else{
+            size_t pos = lowerBound(index);
+            if (index_array[pos] != index){ // The index is not already in the vector
+                index_array.insert(std::begin(index_array) + pos, index);
+                value_array.insert(std::begin(value_array) + pos, value);
+                ret_val = true;
+            }
+        }
     }
 
     return ret_val;
 }
 
+void PackedVector::append(uint32_t index, double value){
+    if (sealed && !index_array.empty() && index_array.back() >= index){ // Out of order or duplicate, seal needs to sort the arrays
+        sealed = false;
+    }
+    index_array.push_back(index);
+    value_array.push_back(value);
+}
+
+void PackedVector::seal(){
+    ensureSealed();
+}
+
+void PackedVector::sortAndMerge() const {
+    std::vector<std::pair<uint32_t, double>> elems;
+    elems.reserve(index_array.size());
+    for (size_t i = 0; i < index_array.size(); i++){
+        elems.emplace_back(index_array[i], value_array[i]);
+    }
+    std::stable_sort(std::begin(elems), std::end(elems), [](const std::pair<uint32_t, double>& a, const std::pair<uint32_t, double>& b){
+        return a.first < b.first;
+    });
+
+    size_t n = 0;
+    for (size_t i = 0; i < elems.size(); i++){ // Write back the sorted elements, summing the values of the duplicate indices
+        if (n != 0 && index_array[n - 1] == elems[i].first){
+            value_array[n - 1] += elems[i].second;
+        }
+        else{
+            index_array[n] = elems[i].first;
+            value_array[n] = elems[i].second;
+            ++n;
+        }
+    }
+    index_array.resize(n);
+    value_array.resize(n);
+
+    sealed = true;
+}
+
 bool PackedVector::remove(uint32_t index){
-    auto response = values.erase(index);
+    size_t pos = lowerBound(index);
+    bool ret_val = pos < index_array.size() && index_array[pos] == index;
+    if (ret_val){
+        index_array.erase(std::begin(index_array) + pos);
+        value_array.erase(std::begin(value_array) + pos);
+    }
 
-    return response == 1 ? true : false;
+    return ret_val;
 }
 
 void PackedVector::set(uint32_t index, double value){
-    values[index] = value;
+    size_t pos = lowerBound(index);
+    if (pos < index_array.size() && index_array[pos] == index){
+        value_array[pos] = value;
+    }
+    else{
+        index_array.insert(std::begin(index_array) + pos, index);
+        value_array.insert(std::begin(value_array) + pos, value);
+    }
+}
+
+void PackedVector::reserve(size_t n){
+    index_array.reserve(n);
+    value_array.reserve(n);
 }
 
 double PackedVector::get(uint32_t index) const {
-    return values.find(index) != std::end(values) ? values.at(index) : 0;
+    size_t pos = lowerBound(index);
+    return pos < index_array.size() && index_array[pos] == index ? value_array[pos] : 0;
 }
 
 double PackedVector::at(uint32_t index) const {
@@ -54,102 +146,126 @@ double PackedVector::operator[](uint32_t index) const {
 }
 
 bool PackedVector::has(uint32_t index) const {
-    return values.find(index) != std::end(values);
+    size_t pos = lowerBound(index);
+    return pos < index_array.size() && index_array[pos] == index;
 }
 
 void PackedVector::clear(){
-    values.clear();
+    index_array.clear();
+    value_array.clear();
+    sealed = true;
 }
 
 size_t PackedVector::size() const {
-    return values.size();
+    ensureSealed();
+    return index_array.size();
 }
 
-std::vector<uint32_t> PackedVector::indices() const {
-    std::vector<uint32_t> ret_val;
-    for( auto pair : values){
-        ret_val.push_back(pair.first);
-    }
-    return ret_val;
+Span<uint32_t> PackedVector::indices() const {
+    ensureSealed();
+    return Span<uint32_t>(index_array);
 }
 
 uint32_t PackedVector::maxIndex() const {
-    if (begin() == end())
+    ensureSealed();
+    if (index_array.empty())
         throw std::out_of_range("Empty PackedVector, so no maximum index\n");
-    return (--std::end(values))->first;
+    return index_array.back();
 }
 
 uint32_t PackedVector::dimension() const {
-    uint32_t ret_val = 0;
-    if ( begin() != end() ){
-        ret_val = ( (--end())->first ) + 1;
-    }
-
-    return ret_val;
+    ensureSealed();
+    return index_array.empty() ? 0 : index_array.back() + 1;
 }
 
-const std::vector<Element> PackedVector::elements() const {
-    std::vector<Element> ret_val;
-
-    for (auto e : values){
-        ret_val.emplace_back(e.first, e.second);
-    }
-
-    return ret_val;
+PackedVector::ElementView PackedVector::elements() const {
+    ensureSealed();
+    return ElementView(Span<uint32_t>(index_array), Span<double>(value_array));
 }
 
-const std::map<uint32_t, double> PackedVector::data() const {
-    return values;
+Span<double> PackedVector::data() const {
+    ensureSealed();
+    return Span<double>(value_array);
 }
 
 std::string PackedVector::toString() const {
     std::string ret_val;
 
-    for (auto e : values){
+    for (auto e : *this){
         ret_val += std::to_string(e.first) + " : " + std::to_string(e.second) + "\n";
     }
 
     return ret_val;
 }
 
-std::map<uint32_t, double>::const_iterator PackedVector::begin() const {
-    return std::begin(values);
+PackedVector::const_iterator PackedVector::begin() const {
+    ensureSealed();
+    return const_iterator(index_array.data(), value_array.data());
 }
 
-std::map<uint32_t, double>::const_iterator PackedVector::end() const {
-    return std::end(values);
+PackedVector::const_iterator PackedVector::end() const {
+    ensureSealed();
+    return const_iterator(index_array.data() + index_array.size(), value_array.data() + value_array.size());
 }
 
 
 ////////////////////////////////////////////////////////////////////////////////////
 
-PackedVector binaryOP(const PackedVector& v1, const PackedVector& v2, std::function<double(double, double)> op){
-    PackedVector ret_val;
+namespace {
 
-    auto v1_ind = v1.indices();
-    auto v2_ind = v2.indices();
-    std::vector<uint32_t> indices;
+/// Linear merge of the sorted arrays of two PackedVector. The values that are not above the threshold are not stored, like with PackedVector::insert
+template <typename OP>
+PackedVector mergeOP(const PackedVector& v1, const PackedVector& v2, OP op){
+    PackedVector ret_val;
 
-    std::merge(begin(v1_ind), end(v1_ind), begin(v2_ind), end(v2_ind), std::back_inserter(indices));
-    indices.erase(std::unique(begin(indices), end(indices)), end(indices));
+    Span<uint32_t> i1 = v1.indices();
+    Span<uint32_t> i2 = v2.indices();
+    Span<double> d1 = v1.data();
+    Span<double> d2 = v2.data();
+    ret_val.reserve(i1.size() + i2.size());
+
+    size_t k1 = 0;
+    size_t k2 = 0;
+    while (k1 < i1.size() || k2 < i2.size()){ // Indices are appended in increasing order, so the result stays sealed
+        uint32_t index;
+        double value;
+        if (k2 == i2.size() || (k1 < i1.size() && i1[k1] < i2[k2])){
+            index = i1[k1];
+            value = op(d1[k1++], 0);
+        }
+        else if (k1 == i1.size() || i2[k2] < i1[k1]){
+            index = i2[k2];
+            value = op(0, d2[k2++]);
+        }
+        else{
+            index = i1[k1];
+            value = op(d1[k1++], d2[k2++]);
+        }
 
-    for ( auto e : indices ){
-        ret_val.insert(e, op(v1[e], v2[e]) );
+        if (std::abs(value) > PackedVector::ZERO_THRESHOLD){
+            ret_val.append(index, value);
+        }
     }
 
     return ret_val;
 }
 
+}
+
+PackedVector binaryOP(const PackedVector& v1, const PackedVector& v2, std::function<double(double, double)> op){
+    return mergeOP(v1, v2, op);
+}
+
 
 PackedVector operator+(const PackedVector& v1, const PackedVector& v2){
 
-    return binaryOP(v1, v2, [](double v1, double v2) -> double {
+    return mergeOP(v1, v2, [](double v1, double v2) -> double {
         return v1 + v2;
     });
 }
 
 PackedVector operator-(const PackedVector& v1, const PackedVector& v2){
-    return binaryOP(v1, v2, [](double v1, double v2) -> double {
+    return mergeOP(v1, v2, [](double v1, double v2) -> double {
         return v1 - v2;
     });
 }
@@ -157,23 +273,71 @@ PackedVector operator-(const PackedVector& v1, const PackedVector& v2){
 double dotProduct(const PackedVector& v1, const PackedVector& v2){
     double ret_val = 0;
 
-    auto it_v1 = v1.begin();
-    auto it_v2 = v2.begin();
+    const uint32_t* i1 = v1.indices().data();
+    const uint32_t* i2 = v2.indices().data();
+    const double* d1 = v1.data().data();
+    const double* d2 = v2.data().data();
 
-    auto it_v1_end = v1.end();
-    auto it_v2_end = v2.end();
+    size_t k1 = 0;
+    size_t k2 = 0;
+    size_t n1 = v1.size();
+    size_t n2 = v2.size();
 
-    while (it_v1 != it_v1_end && it_v2 != it_v2_end){
-        if ( it_v1->first < it_v2->first ) ++it_v1;
-        else if ( it_v1->first > it_v2->first ) ++it_v2;
+    while (k1 < n1 && k2 < n2){
+        if ( i1[k1] < i2[k2] ) ++k1;
+        else if ( i1[k1] > i2[k2] ) ++k2;
         else{
-            ret_val += it_v1->second * it_v2->second;
-            ++it_v1;
-            ++it_v2;
+            ret_val += d1[k1++] * d2[k2++];
         }
     }
     
     return ret_val;
 }
 
-}
\ No newline at end of file
+double dotProduct(const PackedVector& v, const std::vector<double>& dense){
+    const uint32_t* indices = v.indices().data();
+    const double* values = v.data().data();
+    const double* x = dense.data();
+    size_t n = v.size();
+
+    if (n != 0 && v.maxIndex() >= dense.size()){
+        throw std::out_of_range("PackedVector of dimension " + std::to_string(v.dimension()) + " does not fit in a dense vector of size " + std::to_string(dense.size()));
+    }
+
+    double ret_val = 0;
+    size_t k = 0;
+
+#ifdef __AVX2__
+    if (dense.size() <= (size_t)std::numeric_limits<int32_t>::max()){ // The gather instructions take signed 32 bits offsets
+        const __m256d zero = _mm256_setzero_pd();
+        const __m256d all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1)); // Gather the 4 lanes. The masked form avoids an uninitialized source operand
+        __m256d acc0 = zero;
+        __m256d acc1 = zero;
+        for (; k + 8 <= n; k += 8){ // Two independent accumulators to hide the latency of the gathers
+            __m128i idx0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(indices + k));
+            __m128i idx1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(indices + k + 4));
+            __m256d x0 = _mm256_mask_i32gather_pd(zero, x, idx0, all, 8);
+            __m256d x1 = _mm256_mask_i32gather_pd(zero, x, idx1, all, 8);
+#ifdef __FMA__
+            acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(values + k), x0, acc0);
+            acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(values + k + 4), x1, acc1);
+#else
+            acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(_mm256_loadu_pd(values + k), x0));
+            acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(_mm256_loadu_pd(values + k + 4), x1));
+#endif
+        }
+        acc0 = _mm256_add_pd(acc0, acc1);
+        __m128d sum = _mm_add_pd(_mm256_castpd256_pd128(acc0), _mm256_extractf128_pd(acc0, 1));
+        sum = _mm_add_sd(sum, _mm_unpackhi_pd(sum, sum));
+        ret_val = _mm_cvtsd_f64(sum);
+    }
+#endif
+
+    for (; k < n; k++){ // Scalar fallback, and remainder of the vectorized loop
+        ret_val += values[k] * x[indices[k]];
+    }
+
+    return ret_val;
+}
+
+}
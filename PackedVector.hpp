@@ -1,9 +1,15 @@
 #ifndef _PACKED_VECTOR_HPP
 #define _PACKED_VECTOR_HPP
 
-#include <map>
 #include <vector>
 #include <functional>
+#include <iterator>
+#include <utility>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+#include "Span.hpp"
 
 namespace Osi2 {
 
@@ -20,10 +26,100 @@ struct Element{
 };
 
 /*! \brief Class to represent a Packed Vector (sparse vector)
+
+    The elements are stored in two parallel arrays, one for the indices and one for the values, sorted by index.
+    Lookups are binary searches, and merges between two PackedVector (sum, difference, dot product) run in linear time.
+
+    The vector is either sealed (sorted, no duplicate index) or unsealed. insert, remove, set and the lookup functions keep it sealed.
+    append only pushes at the end of the arrays without any check, which is the fast way to fill a vector : a vector built with
+    append is unsealed until seal is called. The lookup functions seal it on demand, so a vector shared between threads must be
+    sealed before being read concurrently.
  */
 class PackedVector {
 
     public:
+        /// Iterator over the (index, value) pairs of the PackedVector, in increasing index order
+        class const_iterator {
+            public:
+                typedef std::random_access_iterator_tag iterator_category;
+                typedef std::pair<uint32_t, double> value_type;
+                typedef std::ptrdiff_t difference_type;
+                typedef const value_type* pointer;
+                typedef value_type reference;
+
+                /// Holds a pair so that it->first and it->second work on a value built on the fly
+                struct Arrow {
+                    value_type pair;
+                    const value_type* operator->() const { return &pair; }
+                };
+
+                const_iterator() : indices(nullptr), values(nullptr) {}
+                const_iterator(const uint32_t* i, const double* v) : indices(i), values(v) {}
+
+                value_type operator*() const { return value_type(*indices, *values); }
+                Arrow operator->() const { return Arrow{**this}; }
+                value_type operator[](std::ptrdiff_t n) const { return value_type(indices[n], values[n]); }
+
+                const_iterator& operator++() { ++indices; ++values; return *this; }
+                const_iterator operator++(int) { const_iterator ret_val(*this); ++(*this); return ret_val; }
+                const_iterator& operator--() { --indices; --values; return *this; }
+                const_iterator operator--(int) { const_iterator ret_val(*this); --(*this); return ret_val; }
+                const_iterator& operator+=(std::ptrdiff_t n) { indices += n; values += n; return *this; }
+                const_iterator& operator-=(std::ptrdiff_t n) { indices -= n; values -= n; return *this; }
+                const_iterator operator+(std::ptrdiff_t n) const { return const_iterator(indices + n, values + n); }
+                const_iterator operator-(std::ptrdiff_t n) const { return const_iterator(indices - n, values - n); }
+                std::ptrdiff_t operator-(const const_iterator& other) const { return indices - other.indices; }
+
+                bool operator==(const const_iterator& other) const { return indices == other.indices; }
+                bool operator!=(const const_iterator& other) const { return indices != other.indices; }
+                bool operator<(const const_iterator& other) const { return indices < other.indices; }
+
+            private:
+                const uint32_t* indices;
+                const double* values;
+        };
+
+        /// Read-only view over the Element pairs of the PackedVector, built on the fly from the two arrays
+        class ElementView {
+            public:
+                /// Iterator yielding Element by value
+                class const_iterator {
+                    public:
+                        typedef std::forward_iterator_tag iterator_category;
+                        typedef Element value_type;
+                        typedef std::ptrdiff_t difference_type;
+                        typedef const Element* pointer;
+                        typedef Element reference;
+
+                        const_iterator(const uint32_t* i, const double* v) : indices(i), values(v) {}
+
+                        Element operator*() const { return Element(*indices, *values); }
+                        const_iterator& operator++() { ++indices; ++values; return *this; }
+                        const_iterator operator++(int) { const_iterator ret_val(*this); ++(*this); return ret_val; }
+                        bool operator==(const const_iterator& other) const { return indices == other.indices; }
+                        bool operator!=(const const_iterator& other) const { return indices != other.indices; }
+
+                    private:
+                        const uint32_t* indices;
+                        const double* values;
+                };
+
+                ElementView(Span<uint32_t> indices, Span<double> values) : indices(indices), values(values) {}
+
+                size_t size() const { return indices.size(); }
+                bool empty() const { return indices.empty(); }
+                Element operator[](size_t i) const { return Element(indices[i], values[i]); }
+                const_iterator begin() const { return const_iterator(indices.begin(), values.begin()); }
+                const_iterator end() const { return const_iterator(indices.end(), values.end()); }
+
+            private:
+                Span<uint32_t> indices; ///< Indices of the elements
+                Span<double> values; ///< Values of the elements
+        };
+
+        /// Values whose absolute value is not greater than this threshold are not stored by insert
+        static constexpr double ZERO_THRESHOLD = 0.01; //TODO Change that
+
         /// \name Constructors
         //{@
 
@@ -38,20 +134,32 @@ class PackedVector {
 
         /// Move constructor
         PackedVector(PackedVector&& other);
+
+        /// Move assignment operator
+        PackedVector& operator=(PackedVector&& other);
         //@}
 
         /// \name Editing functions
         //{@
 
-        /// Insert a value at a given index. Does not store zeros.
+        /// Insert a value at a given index. Does not store zeros. Returns false if the index is already in the vector
         bool insert(uint32_t index, double value);
 
+        /// Append a value at the end of the arrays, without any check. The vector stays unsealed until seal is called if the index is not the greatest one
+        void append(uint32_t index, double value);
+
+        /// Sort the elements appended by index, and sum the values of duplicate indices
+        void seal();
+
         /// Remove the value at a given index
         bool remove(uint32_t index);
 
         /// Set the value at an existing index. Does store zeros. Prefer the insert method.
         void set(uint32_t index, double value);
 
+        /// Make room for n elements
+        void reserve(size_t n);
+
         /// Clear the content of the PackedVector
         void clear();
         //@}
@@ -78,8 +186,11 @@ class PackedVector {
         /// Get the size of the PackedVector (the number of elements stored)
         size_t size() const;
 
-        /// Get a vector of the indices of the PackedVector
-        std::vector<uint32_t> indices() const;
+        /// Check if the vector is sorted and without duplicates
+        bool isSealed() const { return sealed; }
+
+        /// Get a view over the sorted indices of the PackedVector. Invalidated by any modification of the vector
+        Span<uint32_t> indices() const;
 
         /// Get the greatest index in the PackedVector
         uint32_t maxIndex() const;
@@ -87,11 +198,11 @@ class PackedVector {
         /// Get the dimension of the PackedVector
         uint32_t dimension() const;
 
-        /// Get the Element pairs as a std::vector
-        const std::vector<Element> elements() const;
+        /// Get a view over the Element pairs. Invalidated by any modification of the vector
+        ElementView elements() const;
 
-        /// Get the map containing the Element pairs
-        const std::map<uint32_t, double> data() const;
+        /// Get a view over the values of the PackedVector, in the same order as indices(). Invalidated by any modification of the vector
+        Span<double> data() const;
 
         /// Get a std::string representation of the PackedVector
         std::string toString() const;
@@ -101,18 +212,29 @@ class PackedVector {
         //{@
 
         /// Get the begin iterator of the PackedVector
-        std::map<uint32_t, double>::const_iterator begin() const;
+        const_iterator begin() const;
 
         /// Get the end iterator of the PackedVector
-        std::map<uint32_t, double>::const_iterator end() const;
+        const_iterator end() const;
         //@}
 
     private:
-        std::map<uint32_t, double> values; ///< Map containing the PackedVector's values
+        /// Seal the vector if elements were appended since the last time it was sealed
+        void ensureSealed() const { if (!sealed) sortAndMerge(); }
+
+        /// Sort the arrays by index and sum the duplicates. Const because the lookup functions seal the vector on demand
+        void sortAndMerge() const;
+
+        /// Get the position of the first index not lesser than a given index
+        size_t lowerBound(uint32_t index) const;
+
+        mutable std::vector<uint32_t> index_array; ///< Indices of the elements, sorted when the vector is sealed
+        mutable std::vector<double> value_array; ///< Values of the elements, in the same order as index_array
+        mutable bool sealed = true; ///< True if index_array is sorted and has no duplicates
 };
 
 /// Apply a function to each elements 1 on 1 between two PackedVector, and return the result as a PackedVector
-PackedVector binaryOP(const PackedVector& v1, const PackedVector& v2, std::function<PackedVector(const PackedVector&, const PackedVector&)> op);
+PackedVector binaryOP(const PackedVector& v1, const PackedVector& v2, std::function<double(double, double)> op);
 
 /// Sum of two PackedVector
 PackedVector operator+(const PackedVector& v1, const PackedVector& v2);
@@ -123,6 +245,9 @@ PackedVector operator-(const PackedVector& v1, const PackedVector& v2);
 /// Dot product of two PackedVector
 double dotProduct(const PackedVector& v1, const PackedVector& v2);
 
+/// Dot product of a PackedVector and a dense vector. Uses AVX2 gathers when the code is compiled with AVX2 support
+double dotProduct(const PackedVector& v, const std::vector<double>& dense);
+
 }
 
-#endif // _PACKED_VECTOR_HPP
\ No newline at end of file
+#endif // _PACKED_VECTOR_HPP
@@ -0,0 +1,183 @@
+#include "Parallel.hpp"
+
+#include <atomic>
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+
+namespace Osi2 {
+
+namespace {
+
+std::atomic<size_t> thread_count_setting(0); ///< Thread count set by the user, 0 for the default
+
+thread_local bool in_tasks = false; ///< True while the thread runs tasks, a nested call runs its tasks in place
+
+/// Tasks of a call to runTasks, on the stack of the calling thread
+struct Job {
+    void (*call)(void*, size_t); ///< Function of the tasks
+    void* context; ///< First argument of call
+    size_t task_count; ///< Number of tasks
+    std::atomic<size_t> next; ///< Next task to run
+    size_t finished; ///< Number of tasks over
+    size_t active; ///< Number of workers running tasks of the job
+    size_t error_task; ///< Task of the exception kept in error
+    std::exception_ptr error; ///< Exception of the task of lowest index, if any
+};
+
+/*! \brief Threads waiting for jobs, created on demand and joined at the end of the process
+
+    One job runs at a time : the workers and the calling thread take its tasks from an atomic counter. The caller waits until
+    every task is over and every worker has left the job, so the job can live on its stack.
+ */
+class Pool {
+    public:
+        ~Pool(){
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            wake.notify_all();
+            for (auto& w : workers){
+                w.join();
+            }
+        }
+
+        /// Run the tasks of a job. Returns false without running anything if another thread uses the pool
+        bool run(Job& job, size_t worker_count){
+            std::unique_lock<std::mutex> job_lock(job_mutex, std::try_to_lock);
+            if (!job_lock.owns_lock()){
+                return false;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                while (workers.size() < worker_count){
+                    workers.emplace_back([this]{ work(); });
+                }
+                current = &job;
+                ++generation;
+            }
+            wake.notify_all();
+
+            size_t done = runJob(job);
+
+            std::unique_lock<std::mutex> lock(mutex);
+            job.finished += done;
+            finished.wait(lock, [&job]{ return job.finished == job.task_count && job.active == 0; });
+            current = nullptr;
+            return true;
+        }
+
+        /// Run tasks of a job until there are no more, returns the number run
+        static size_t runJob(Job& job){
+            size_t ret_val = 0;
+            for (size_t t; (t = job.next.fetch_add(1)) < job.task_count; ++ret_val){
+                try{
+                    job.call(job.context, t);
+                }catch(...){
+                    keepError(job, t);
+                }
+            }
+            return ret_val;
+        }
+
+        /// Keep the exception being handled if its task is the first one to fail
+        static void keepError(Job& job, size_t task){
+            static std::mutex error_mutex;
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!job.error || task < job.error_task){
+                job.error = std::current_exception();
+                job.error_task = task;
+            }
+        }
+
+    private:
+        void work(){
+            in_tasks = true;
+            size_t seen = 0; // Last generation this worker took part in
+            std::unique_lock<std::mutex> lock(mutex);
+            while (true){
+                wake.wait(lock, [&]{ return stopping || (current != nullptr && generation != seen); });
+                if (stopping){
+                    return;
+                }
+                seen = generation;
+                Job& job = *current;
+                ++job.active;
+                lock.unlock();
+
+                size_t done = runJob(job);
+
+                lock.lock();
+                job.finished += done;
+                --job.active;
+                if (job.finished == job.task_count && job.active == 0){
+                    finished.notify_all();
+                }
+            }
+        }
+
+        std::mutex job_mutex; ///< Held by the thread whose job runs
+        std::mutex mutex; ///< Protects the members below and the finished and active counters of the job
+        std::condition_variable wake; ///< Signals a new job or the end of the process to the workers
+        std::condition_variable finished; ///< Signals the end of a job to its caller
+        std::vector<std::thread> workers; ///< Threads of the pool
+        Job* current = nullptr; ///< Job being run, nullptr if none
+        size_t generation = 0; ///< Number of jobs started
+        bool stopping = false; ///< True when the workers must return
+};
+
+Pool& pool(){
+    static Pool ret_val;
+    return ret_val;
+}
+
+}
+
+size_t threadCount(){
+    size_t ret_val = thread_count_setting.load(std::memory_order_relaxed);
+    if (ret_val == 0){
+        ret_val = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    return ret_val;
+}
+
+void setThreadCount(size_t count){
+    thread_count_setting.store(count, std::memory_order_relaxed);
+}
+
+size_t threadCountFor(size_t work, size_t min_work_per_thread){
+    return std::max(size_t(1), std::min(threadCount(), work / std::max(size_t(1), min_work_per_thread)));
+}
+
+void runTasks(size_t task_count, void (*call)(void*, size_t), void* context){
+    Job job;
+    job.call = call;
+    job.context = context;
+    job.task_count = task_count;
+    job.next = 0;
+    job.finished = 0;
+    job.active = 0;
+    job.error_task = 0;
+
+    bool was_in_tasks = in_tasks;
+    in_tasks = true;
+    try{
+        if (task_count <= 1 || was_in_tasks || !pool().run(job, task_count - 1)){ // Nothing to share, nested call or pool in use : run the tasks here
+            Pool::runJob(job);
+        }
+    }catch(...){ // A worker could not be created
+        in_tasks = was_in_tasks;
+        throw;
+    }
+    in_tasks = was_in_tasks;
+
+    if (job.error){
+        std::rethrow_exception(job.error);
+    }
+}
+
+}
@@ -0,0 +1,41 @@
+#ifndef _PARALLEL_HPP
+#define _PARALLEL_HPP
+
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace Osi2 {
+
+/// \name Parallel helpers
+//{@
+
+/// Get the number of threads used by the parallel kernels. Defaults to the number of hardware threads
+size_t threadCount();
+
+/// Set the number of threads used by the parallel kernels. 0 restores the default
+void setThreadCount(size_t count);
+
+/// Get the number of threads worth using for a given amount of work, at most threadCount() and at least 1
+size_t threadCountFor(size_t work, size_t min_work_per_thread);
+
+/*! \brief Run call(context, t) for each t in [0, task_count) on the threads of the process pool, see parallelFor
+ */
+void runTasks(size_t task_count, void (*call)(void*, size_t), void* context);
+
+/*! \brief Run fn(t) for each t in [0, thread_count), on thread_count threads
+
+    The threads are taken from a pool created on first use and kept until the end of the process, and the calling thread runs
+    tasks too, so a thread_count of 1 never uses the pool. A call made from inside a task, or while another thread uses the pool,
+    runs its tasks one after the other in the calling thread : the tasks must not wait for each other.
+    If tasks throw, the exception of the task of lowest index is thrown again once all the tasks are over.
+ */
+template <typename F>
+void parallelFor(size_t thread_count, F fn){
+    runTasks(thread_count, [](void* context, size_t t){ (*static_cast<F*>(context))(t); }, &fn);
+}
+//@}
+
+}
+
+#endif // _PARALLEL_HPP
@@ -20,16 +20,30 @@ QuadraticConstraint::QuadraticConstraint(const QuadraticExpr& expr) {
     setFormat(ExpressionConstraint::Format::LE);
 }
 
+QuadraticConstraint::QuadraticConstraint(QuadraticExpr&& expr) {
+    setExpr(std::move(expr));
+    setFormat(ExpressionConstraint::Format::LE);
+}
+
 QuadraticConstraint::QuadraticConstraint(const QuadraticConstraint& other) : ExpressionConstraint(other) {
     setExpr(other.getExpr());
     setBounds(other.getBounds());
     setFormat(other.getFormat());
 }
 
-QuadraticConstraint::QuadraticConstraint(QuadraticConstraint&& other) {
-    std::swap(expr, other.expr);
-    setBounds(other.getBounds());
-    setFormat(other.getFormat());
+QuadraticConstraint::QuadraticConstraint(QuadraticConstraint&& other) : ExpressionConstraint(std::move(other)) {}
+
+QuadraticConstraint& QuadraticConstraint::operator=(QuadraticConstraint&& other){
+    ExpressionConstraint::operator=(std::move(other));
+
+    return (*this);
+}
+
+ExpressionConstraint&& QuadraticConstraint::checkQuadratic(ExpressionConstraint&& other){
+    if (other.getType() != Constraint::Type::QUADRATIC){
+        throw std::invalid_argument("Error, bad conversion");
+    }
+    return std::move(other);
 }
 
 QuadraticConstraint& QuadraticConstraint::operator=(const QuadraticConstraint& other){
@@ -81,6 +95,39 @@ QuadraticConstraint operator<=( double low, const QuadraticConstraint& c){
     return ret_val;
 }
 
+QuadraticConstraint operator<=(QuadraticConstraint&& c, double up){
+    c.setUpperBound(up);
+    if ( c.getBounds().lower_bound == up ){
+        c.setFormat(ExpressionConstraint::Format::EQ);
+    }
+    else {
+       c.setFormat(ExpressionConstraint::Format::LE); 
+    }
+
+    return std::move(c);
+}
+
+QuadraticConstraint operator<=(double low, QuadraticConstraint&& c){
+    c.setLowerBound(low);
+    if ( c.getBounds().upper_bound == low ){
+        c.setFormat(ExpressionConstraint::Format::EQ);
+    }
+    else {
+       c.setFormat(ExpressionConstraint::Format::LE); 
+    }
+
+    return std::move(c);
+}
+
+QuadraticConstraint operator==(QuadraticExpr&& exp1, double n){
+    QuadraticConstraint ret_val(std::move(exp1));
+
+    ret_val.setBounds(Range(n));
+    ret_val.setFormat(ExpressionConstraint::Format::EQ);
+
+    return ret_val;
+}
+
 QuadraticConstraint operator==(const QuadraticExpr& exp1, double n){
     QuadraticConstraint ret_val;
 
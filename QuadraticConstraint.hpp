@@ -27,6 +27,9 @@ class QuadraticConstraint : public ExpressionConstraint {
             }
         }
 
+        /// Conversion from a temporary ExpressionContraint, adopts its expression
+        QuadraticConstraint(ExpressionConstraint&& other) : ExpressionConstraint(checkQuadratic(std::move(other))) {}
+
         /// Constructs a linear constraint with a linear expression and a double
         /// This represents a constraint such as : expr = n
         QuadraticConstraint(const QuadraticExpr& expr, double n);
@@ -38,6 +41,9 @@ class QuadraticConstraint : public ExpressionConstraint {
         /// Allow conversion from a linear expression to a constraint with infinite bounds. Usefull to build constraints with operator overload
         QuadraticConstraint(const QuadraticExpr& expr);
 
+        /// Conversion from a temporary quadratic expression, moved into the constraint
+        QuadraticConstraint(QuadraticExpr&& expr);
+
         /// Copy constructor
         QuadraticConstraint(const QuadraticConstraint& other);
 
@@ -47,6 +53,9 @@ class QuadraticConstraint : public ExpressionConstraint {
         // Move constructor
         QuadraticConstraint(QuadraticConstraint&& other);
 
+        /// Move assignment operator
+        QuadraticConstraint& operator=(QuadraticConstraint&& other);
+
         // Destructor
         virtual ~QuadraticConstraint(){}
         //@}
@@ -62,7 +71,13 @@ class QuadraticConstraint : public ExpressionConstraint {
         //{@
         virtual void setExpr(const Expression& exp) { this->expr = std::make_shared<QuadraticExpr>(exp); }
 
+        /// Set the expression inside the constraint, moving a temporary quadratic expression
+        void setExpr(QuadraticExpr&& exp) { this->expr = std::make_shared<QuadraticExpr>(std::move(exp)); }
         //@}
+
+    private:
+        /// Check the type of a constraint before moving from it
+        static ExpressionConstraint&& checkQuadratic(ExpressionConstraint&& other);
 };
 
 /// \name Operators overload
@@ -77,6 +92,15 @@ QuadraticConstraint operator<=(double up, const QuadraticConstraint& c);
 /// Equal to comparison operator. Used to create constraints in a more mathematical language.
 QuadraticConstraint operator==(const QuadraticExpr& exp1, double n);
 
+/// Lesser than or equal to comparison operator on a temporary constraint, which is reused instead of copied
+QuadraticConstraint operator<=(QuadraticConstraint&& c, double up);
+
+/// Lesser than or equal to comparison operator on a temporary constraint, which is reused instead of copied
+QuadraticConstraint operator<=(double low, QuadraticConstraint&& c);
+
+/// Equal to comparison operator on a temporary expression, which is moved into the constraint
+QuadraticConstraint operator==(QuadraticExpr&& exp1, double n);
+
 /// Ostream operator
 std::ostream& operator<<(std::ostream& flux, const QuadraticConstraint& constr);
 //@}
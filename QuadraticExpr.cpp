@@ -17,7 +17,12 @@ QuadraticExpr& QuadraticExpr::operator=(const QuadraticExpr& other){
     return (*this);
 }
 
-QuadraticExpr::QuadraticExpr(QuadraticExpr&& other) : Expression(other) {}
+QuadraticExpr::QuadraticExpr(QuadraticExpr&& other) : Expression(std::move(other)) {}
+
+QuadraticExpr& QuadraticExpr::operator=(QuadraticExpr&& other){
+    Expression::operator=(std::move(other));
+    return (*this);
+}
 
 std::shared_ptr<Expression> QuadraticExpr::clone() const {
     auto ret_val = std::make_shared<QuadraticExpr>();
@@ -31,19 +36,15 @@ std::shared_ptr<Expression> QuadraticExpr::clone() const {
 }
 
 void QuadraticExpr::add(const QuadraticExpr& expr){
-    for ( const auto& term : expr.getTerms() ){
-        addTerm(term);
+    for ( const auto& term : expr.getTerms() ){ // Copy the terms : sharing them would let mult or divide modify expr too
+        addTerm(std::make_shared<QuadraticTerm>(*static_cast<QuadraticTerm*>(term.get())));
     }
 }
 
 void QuadraticExpr::substract(const QuadraticExpr& expr){
     for ( const auto& term : expr.getTerms() ){
-        if (QuadraticTerm* t = static_cast<QuadraticTerm*>(term.get())){
-            t->coefs[0] = -t->coefs[0];
-            t->coefs[1] = -t->coefs[1];
-            t->coefs[2] = -t->coefs[2];
-            addTerm(std::make_shared<QuadraticTerm>(*t)); //TODO check that
-        }      
+        const QuadraticTerm* t = static_cast<QuadraticTerm*>(term.get());
+        addTerm(-t->coefs[2], -t->coefs[1], -t->coefs[0], t->var); // Negated copy, expr is left untouched
     }
 }
 
@@ -186,5 +187,30 @@ QuadraticExpr operator/(const QuadraticExpr& e, double scalar){
     return divide(e,scalar);
 }
 
+QuadraticExpr operator+(QuadraticExpr&& a, const QuadraticExpr& b){
+    a.add(b);
+    return std::move(a);
+}
+
+QuadraticExpr operator-(QuadraticExpr&& a, const QuadraticExpr& b){
+    a.substract(b);
+    return std::move(a);
+}
+
+QuadraticExpr operator*(double scalar, QuadraticExpr&& e){
+    e.mult(scalar);
+    return std::move(e);
+}
+
+QuadraticExpr operator*(QuadraticExpr&& e, double scalar){
+    e.mult(scalar);
+    return std::move(e);
+}
+
+QuadraticExpr operator/(QuadraticExpr&& e, double scalar){
+    e.divide(scalar);
+    return std::move(e);
+}
+
 
 }
\ No newline at end of file
@@ -96,6 +96,9 @@ class QuadraticExpr : public Expression {
 
         /// Move constructor
         QuadraticExpr(QuadraticExpr&& other);
+
+        /// Move assignment operator
+        QuadraticExpr& operator=(QuadraticExpr&& other);
         //@}
 
         /// \name Getters
@@ -190,6 +193,21 @@ QuadraticExpr operator*(const QuadraticExpr& e, double scalar);
 /// Division of a quadratic expression by a scalar
 QuadraticExpr operator/(const QuadraticExpr& e, double scalar);
 
+/// Sum of two quadratic expressions, reusing the terms of the temporary left operand
+QuadraticExpr operator+(QuadraticExpr&& a, const QuadraticExpr& b);
+
+/// Difference of two quadratic expressions, reusing the terms of the temporary left operand
+QuadraticExpr operator-(QuadraticExpr&& a, const QuadraticExpr& b);
+
+/// Multiplication of a temporary quadratic expression by a scalar, in place
+QuadraticExpr operator*(double scalar, QuadraticExpr&& e);
+
+/// Multiplication of a temporary quadratic expression by a scalar, in place
+QuadraticExpr operator*(QuadraticExpr&& e, double scalar);
+
+/// Division of a temporary quadratic expression by a scalar, in place
+QuadraticExpr operator/(QuadraticExpr&& e, double scalar);
+
 /*QuadraticExpr operator+(const QuadraticExpr& a, const LinearExpr& b);
 
 QuadraticExpr operator+(const LinearExpr& a, const QuadraticExpr& b);*/
@@ -0,0 +1,165 @@
+#include "SellMatrix.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#include "Parallel.hpp"
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+namespace Osi2 {
+
+SellMatrix::SellMatrix() : row_count(0), col_count(0), element_count(0), sigma(1) {
+    chunk_start.push_back(0);
+}
+
+SellMatrix::SellMatrix(const DCSRMatrix& matrix, size_t sigma) : row_count(matrix.getRowCount()), col_count(matrix.getColumnCount()), element_count(0), sigma(sigma) {
+    if (sigma == 0){
+        throw std::invalid_argument("Sigma must be greater than 0");
+    }
+
+    std::vector<uint32_t> lengths(row_count, 0); // Number of elements of each row, tombstones excluded
+    for (size_t i = 0; i < row_count; i++){
+        for (const auto& e : matrix.getRowView(i)){
+            lengths[i] += e.second != 0 ? 1 : 0;
+        }
+        element_count += lengths[i];
+    }
+
+    size_t chunk_count = (row_count + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    permutation.assign(chunk_count * CHUNK_SIZE, row_count); // The positions after the last row hold row_count, they are padding only
+    for (size_t i = 0; i < row_count; i++){
+        permutation[i] = i;
+    }
+    if (sigma > 1){
+        for (size_t beg = 0; beg < row_count; beg += sigma){ // Longest rows first inside each window, so that the rows of a chunk have close lengths
+            size_t end = std::min(row_count, beg + sigma);
+            std::stable_sort(permutation.begin() + beg, permutation.begin() + end, [&lengths](uint32_t a, uint32_t b){
+                return lengths[a] > lengths[b];
+            });
+        }
+    }
+
+    chunk_start.assign(chunk_count + 1, 0);
+    for (size_t c = 0; c < chunk_count; c++){ // Each chunk is as wide as its longest row
+        uint32_t width = 0;
+        for (size_t r = c * CHUNK_SIZE; r < (c + 1) * CHUNK_SIZE && permutation[r] < row_count; r++){
+            width = std::max(width, lengths[permutation[r]]);
+        }
+        chunk_start[c + 1] = chunk_start[c] + width * CHUNK_SIZE;
+    }
+
+    col_indices.assign(chunk_start[chunk_count], 0);
+    values.assign(chunk_start[chunk_count], 0);
+
+    size_t thread_count = threadCountFor(element_count, MIN_SLOTS_PER_THREAD);
+    parallelFor(thread_count, [&](size_t t){ // Each thread fills its own range of chunks
+        for (size_t c = chunk_count * t / thread_count; c < chunk_count * (t + 1) / thread_count; c++){
+            for (size_t r = 0; r < CHUNK_SIZE && permutation[c * CHUNK_SIZE + r] < row_count; r++){
+                size_t pos = chunk_start[c] + r;
+                for (const auto& e : matrix.getRowView(permutation[c * CHUNK_SIZE + r])){
+                    if (e.second == 0){ // Tombstone
+                        continue;
+                    }
+                    col_indices[pos] = e.first;
+                    values[pos] = e.second;
+                    pos += CHUNK_SIZE;
+                }
+            }
+        }
+    });
+}
+
+void SellMatrix::multiplyChunk(size_t chunk, const double* x, bool use_gather, double* out) const {
+    const uint32_t* cols = col_indices.data() + chunk_start[chunk];
+    const double* vals = values.data() + chunk_start[chunk];
+    size_t width = (chunk_start[chunk + 1] - chunk_start[chunk]) / CHUNK_SIZE;
+
+#if defined(__AVX512F__)
+    if (use_gather){ // One vector of 8 rows
+        const __m512d zero = _mm512_setzero_pd();
+        __m512d acc = zero;
+        for (size_t k = 0; k < width; k++){
+            __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cols + k * CHUNK_SIZE));
+            __m512d v = _mm512_loadu_pd(vals + k * CHUNK_SIZE);
+            __m512d xk = _mm512_mask_i32gather_pd(zero, _mm512_cmp_pd_mask(v, zero, _CMP_NEQ_UQ), idx, x, 8); // 0 for the padding
+            acc = _mm512_fmadd_pd(v, xk, acc);
+        }
+        _mm512_storeu_pd(out, acc);
+        return;
+    }
+#elif defined(__AVX2__)
+    if (use_gather){ // Two vectors of 4 rows
+        const __m256d zero = _mm256_setzero_pd();
+        __m256d acc0 = zero;
+        __m256d acc1 = zero;
+        for (size_t k = 0; k < width; k++){
+            __m128i idx0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cols + k * CHUNK_SIZE));
+            __m128i idx1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cols + k * CHUNK_SIZE + 4));
+            __m256d v0 = _mm256_loadu_pd(vals + k * CHUNK_SIZE);
+            __m256d v1 = _mm256_loadu_pd(vals + k * CHUNK_SIZE + 4);
+            __m256d x0 = _mm256_mask_i32gather_pd(zero, x, idx0, _mm256_cmp_pd(v0, zero, _CMP_NEQ_UQ), 8); // 0 for the padding
+            __m256d x1 = _mm256_mask_i32gather_pd(zero, x, idx1, _mm256_cmp_pd(v1, zero, _CMP_NEQ_UQ), 8);
+#ifdef __FMA__
+            acc0 = _mm256_fmadd_pd(v0, x0, acc0);
+            acc1 = _mm256_fmadd_pd(v1, x1, acc1);
+#else
+            acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(v0, x0));
+            acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(v1, x1));
+#endif
+        }
+        _mm256_storeu_pd(out, acc0);
+        _mm256_storeu_pd(out + 4, acc1);
+        return;
+    }
+#else
+    (void)use_gather;
+#endif
+
+    for (size_t r = 0; r < CHUNK_SIZE; r++){ // Scalar fallback, the loop over the rows of the chunk can still be vectorized by the compiler
+        out[r] = 0;
+    }
+    for (size_t k = 0; k < width; k++){
+        for (size_t r = 0; r < CHUNK_SIZE; r++){
+            double v = vals[k * CHUNK_SIZE + r];
+            out[r] += v != 0 ? v * x[cols[k * CHUNK_SIZE + r]] : 0.0; // Skip the padding, as x[0] may be infinite or NaN
+        }
+    }
+}
+
+void SellMatrix::multiply(const std::vector<double>& x, std::vector<double>& y) const {
+    if (x.size() < col_count){
+        throw std::invalid_argument("Vector of size " + std::to_string(x.size()) + " is smaller than the " + std::to_string(col_count) + " columns of the matrix");
+    }
+
+    y.assign(row_count, 0.0);
+
+    size_t chunk_count = chunk_start.size() - 1;
+    bool use_gather = x.size() <= (size_t)std::numeric_limits<int32_t>::max(); // The gather instructions take signed 32 bits offsets
+    size_t thread_count = threadCountFor(values.size(), MIN_SLOTS_PER_THREAD);
+
+    std::vector<size_t> bounds(thread_count + 1, chunk_count); // Chunks [bounds[t], bounds[t + 1]) of thread t, with the same number of slots
+    bounds[0] = 0;
+    for (size_t t = 1; t < thread_count; t++){
+        bounds[t] = std::lower_bound(chunk_start.begin(), chunk_start.end() - 1, values.size() * t / thread_count) - chunk_start.begin();
+    }
+
+    parallelFor(thread_count, [&](size_t t){
+        double sums[CHUNK_SIZE];
+        for (size_t c = bounds[t]; c < bounds[t + 1]; c++){
+            multiplyChunk(c, x.data(), use_gather, sums);
+            for (size_t r = 0; r < CHUNK_SIZE; r++){
+                uint32_t row = permutation[c * CHUNK_SIZE + r];
+                if (row < row_count){ // Each row belongs to a single chunk, so the threads write to different elements of y
+                    y[row] = sums[r];
+                }
+            }
+        }
+    });
+}
+
+}
@@ -0,0 +1,78 @@
+#ifndef _SELLMATRIX_HPP
+#define _SELLMATRIX_HPP
+
+#include <vector>
+#include <cstdint>
+
+#include "DCSRMatrix.hpp"
+
+namespace Osi2 {
+
+/*! \brief Read-only sliced ELLPACK (SELL-C-sigma) copy of a DCSRMatrix, for repeated matrix-vector products
+
+    The rows are cut in chunks of CHUNK_SIZE rows. Inside a chunk the elements are stored column major : the k-th element of
+    every row of the chunk are contiguous, so a single SIMD load reads them for all the rows of the chunk. The rows shorter than
+    the longest one of their chunk are padded with zeros. As the tombstones are not copied, a value of 0 marks the padding, which
+    multiply skips : an infinite or NaN element of x only reaches the rows that have a non zero element in its column. To keep the
+    padding low, the rows are sorted by decreasing length inside windows of sigma rows before being cut in chunks (sigma = 1 keeps
+    the original order).
+
+    From a paper of Moritz Kreutzer, Georg Hager, Gerhard Wellein, Holger Fehske and Alan R. Bishop (https://arxiv.org/abs/1307.6209)
+ */
+class SellMatrix {
+    public:
+        static const size_t CHUNK_SIZE = 8; ///< Rows per chunk : one AVX-512 vector of doubles, or two AVX2 ones
+
+        /// \name Constructors
+        //{@
+
+        /// Default constructor, empty matrix
+        SellMatrix();
+
+        /// Copy a DCSRMatrix, fragmented or not. The rows are sorted by length inside windows of sigma rows. Tombstones are not copied
+        SellMatrix(const DCSRMatrix& matrix, size_t sigma = 256);
+        //@}
+
+        /// Compute y = A x. x must have at least getColumnCount() elements, y is resized to getRowCount().
+        /// Uses AVX-512 or AVX2 gathers when the code is compiled with their support. Chunks are split between threads
+        void multiply(const std::vector<double>& x, std::vector<double>& y) const;
+
+        /// \name Getters
+        //{@
+
+        /// Get the number of rows
+        size_t getRowCount() const { return row_count; }
+
+        /// Get the number of columns
+        size_t getColumnCount() const { return col_count; }
+
+        /// Get the number of elements, padding excluded
+        size_t getElementCount() const { return element_count; }
+
+        /// Get the number of stored slots, padding included
+        size_t getSlotCount() const { return values.size(); }
+
+        /// Get the size of the windows in which the rows are sorted by length
+        size_t getSigma() const { return sigma; }
+        //@}
+
+    private:
+        /// Compute the CHUNK_SIZE sums of a chunk in out. The rows of the last chunk that do not exist give 0
+        void multiplyChunk(size_t chunk, const double* x, bool use_gather, double* out) const;
+
+        static const size_t MIN_SLOTS_PER_THREAD = 1 << 15; ///< Below this amount of slots per thread, multiply uses less threads
+
+        size_t row_count; ///< Number of rows
+        size_t col_count; ///< Number of columns
+        size_t element_count; ///< Number of elements, padding excluded
+        size_t sigma; ///< Size of the sorting windows
+
+        std::vector<size_t> chunk_start; ///< Start of each chunk in the arrays, plus the total size at the end
+        std::vector<uint32_t> permutation; ///< Row of the matrix stored at each position, CHUNK_SIZE per chunk
+        std::vector<uint32_t> col_indices; ///< Column index of each slot, 0 for the padding
+        std::vector<double> values; ///< Value of each slot, 0 for the padding
+};
+
+}
+
+#endif // _SELLMATRIX_HPP
@@ -0,0 +1,199 @@
+#ifndef _SMALLVECTOR_HPP
+#define _SMALLVECTOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+
+namespace Osi2 {
+
+/*! \brief Vector with small-buffer storage, for trivially copyable types
+
+    The first N elements are stored inside the object itself, so short vectors do not allocate.
+    Past N elements, the data is moved to the heap and grows geometrically like a std::vector.
+    Elements are copied with memcpy/memmove, so T must be trivially copyable (indices, coefficients, pointers).
+ */
+template <typename T, size_t N>
+class SmallVector {
+    static_assert(std::is_trivially_copyable<T>::value, "SmallVector only holds trivially copyable types");
+
+    public:
+        typedef T value_type;
+        typedef T* iterator;
+        typedef const T* const_iterator;
+
+        /// \name Constructors
+        //{@
+
+        /// Default constructor, does not allocate
+        SmallVector() : ptr(inline_buffer), count(0), cap(N) {}
+
+        /// Copy constructor
+        SmallVector(const SmallVector& other) : ptr(inline_buffer), count(0), cap(N) {
+            reserve(other.count);
+            copyFrom(other.ptr, other.count);
+        }
+
+        /// Assignment operator
+        SmallVector& operator=(const SmallVector& other){
+            if (this != &other){
+                count = 0;
+                reserve(other.count);
+                copyFrom(other.ptr, other.count);
+            }
+            return *this;
+        }
+
+        /// Move constructor. Steals the heap buffer if there is one
+        SmallVector(SmallVector&& other) : ptr(inline_buffer), count(0), cap(N) {
+            steal(other);
+        }
+
+        /// Move assignment operator. Steals the heap buffer if there is one
+        SmallVector& operator=(SmallVector&& other){
+            if (this != &other){
+                release();
+                steal(other);
+            }
+            return *this;
+        }
+
+        /// Destructor
+        ~SmallVector(){ release(); }
+        //@}
+
+        /// \name Editing functions
+        //{@
+
+        /// Append an element
+        void push_back(const T& value){
+            if (count == cap){
+                grow(count + 1);
+            }
+            ptr[count++] = value;
+        }
+
+        /// Insert an element before a given position
+        void insert(size_t pos, const T& value){
+            if (count == cap){
+                grow(count + 1);
+            }
+            std::memmove(ptr + pos + 1, ptr + pos, (count - pos) * sizeof(T));
+            ptr[pos] = value;
+            ++count;
+        }
+
+        /// Erase the element at a given position
+        void erase(size_t pos){
+            std::memmove(ptr + pos, ptr + pos + 1, (count - pos - 1) * sizeof(T));
+            --count;
+        }
+
+        /// Make room for at least n elements
+        void reserve(size_t n){
+            if (n > cap){
+                reallocate(n);
+            }
+        }
+
+        /// Change the number of elements. New elements are left uninitialized
+        void resize(size_t n){
+            reserve(n);
+            count = n;
+        }
+
+        /// Remove all the elements, keeps the memory
+        void clear(){ count = 0; }
+
+        /// Swap the content with an other SmallVector
+        void swap(SmallVector& other){
+            SmallVector temp(std::move(other));
+            other = std::move(*this);
+            *this = std::move(temp);
+        }
+        //@}
+
+        /// \name Getters
+        //{@
+        size_t size() const { return count; }
+        size_t capacity() const { return cap; }
+        bool empty() const { return count == 0; }
+        T* data() { return ptr; }
+        const T* data() const { return ptr; }
+        T& operator[](size_t i) { return ptr[i]; }
+        const T& operator[](size_t i) const { return ptr[i]; }
+        T& back() { return ptr[count - 1]; }
+        const T& back() const { return ptr[count - 1]; }
+        //@}
+
+        /// \name Iterator functions
+        //{@
+        iterator begin() { return ptr; }
+        iterator end() { return ptr + count; }
+        const_iterator begin() const { return ptr; }
+        const_iterator end() const { return ptr + count; }
+        //@}
+
+    private:
+        bool isInline() const { return ptr == inline_buffer; }
+
+        void copyFrom(const T* src, size_t n){
+            if (n != 0){
+                std::memcpy(ptr, src, n * sizeof(T));
+            }
+            count = n;
+        }
+
+        void grow(size_t min_cap){
+            reallocate(std::max(min_cap, cap * 2));
+        }
+
+        void reallocate(size_t new_cap){
+            T* new_ptr = static_cast<T*>(::operator new(new_cap * sizeof(T))); // Throws std::bad_alloc. Through operator new, so that a replaced one sees these allocations
+            if (count != 0){
+                std::memcpy(new_ptr, ptr, count * sizeof(T));
+            }
+            if (!isInline()){
+                ::operator delete(ptr);
+            }
+            ptr = new_ptr;
+            cap = new_cap;
+        }
+
+        void release(){
+            if (!isInline()){
+                ::operator delete(ptr);
+            }
+            ptr = inline_buffer;
+            count = 0;
+            cap = N;
+        }
+
+        void steal(SmallVector& other){
+            if (other.isInline()){ // Nothing to steal, copy the inline elements
+                copyFrom(other.ptr, other.count);
+            }
+            else{
+                ptr = other.ptr;
+                count = other.count;
+                cap = other.cap;
+                other.ptr = other.inline_buffer;
+                other.cap = N;
+            }
+            other.count = 0;
+        }
+
+        T* ptr; ///< Points to the inline buffer or to the heap
+        size_t count; ///< Number of elements
+        size_t cap; ///< Capacity of the current buffer
+        T inline_buffer[N]; ///< Storage for the first N elements
+};
+
+}
+
+#endif // _SMALLVECTOR_HPP
@@ -0,0 +1,56 @@
+#ifndef _SPAN_HPP
+#define _SPAN_HPP
+
+#include <cstddef>
+#include <vector>
+
+namespace Osi2 {
+
+/*! \brief Read-only view over contiguous elements
+
+    Does not own the elements, so it is only valid as long as the container it was taken from is not modified.
+    Copying a Span never allocates.
+ */
+template <typename T>
+class Span {
+    public:
+        typedef T value_type;
+        typedef const T* iterator;
+        typedef const T* const_iterator;
+
+        /// Empty view
+        Span() : ptr(nullptr), count(0) {}
+
+        /// View over count elements starting at ptr
+        Span(const T* ptr, size_t count) : ptr(ptr), count(count) {}
+
+        /// View over the content of a std::vector
+        Span(const std::vector<T>& v) : ptr(v.data()), count(v.size()) {}
+
+        /// \name Getters
+        //{@
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+        const T* data() const { return ptr; }
+        const T& operator[](size_t i) const { return ptr[i]; }
+        const T& front() const { return ptr[0]; }
+        const T& back() const { return ptr[count - 1]; }
+
+        /// Get a view over count elements starting at offset
+        Span subspan(size_t offset, size_t n) const { return Span(ptr + offset, n); }
+        //@}
+
+        /// \name Iterator functions
+        //{@
+        const_iterator begin() const { return ptr; }
+        const_iterator end() const { return ptr + count; }
+        //@}
+
+    private:
+        const T* ptr; ///< First element of the view
+        size_t count; ///< Number of elements in the view
+};
+
+}
+
+#endif // _SPAN_HPP
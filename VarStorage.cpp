@@ -0,0 +1,65 @@
+#include "VarStorage.hpp"
+
+namespace Osi2 {
+
+VarStorage::VarStorage() : count(0), allocated(0) {}
+
+VarStorage::VarStorage(const VarStorage& other) : count(0), allocated(0) {
+    reserve(other.count);
+    for (const auto& v : other){
+        emplace_back(v);
+    }
+}
+
+VarStorage& VarStorage::operator=(const VarStorage& other){
+    if (this != &other){
+        clear();
+        reserve(other.count);
+        for (const auto& v : other){
+            emplace_back(v);
+        }
+    }
+
+    return (*this);
+}
+
+VarStorage::VarStorage(VarStorage&& other) noexcept : count(other.count), allocated(other.allocated) {
+    std::swap(chunks, other.chunks); // Moving the chunks keeps their buffers, so the Var do not move
+    other.count = 0;
+    other.allocated = 0;
+}
+
+VarStorage& VarStorage::operator=(VarStorage&& other) noexcept {
+    if (this != &other){
+        chunks = std::move(other.chunks); // Takes the buffers of other, the Var do not move
+        count = other.count;
+        allocated = other.allocated;
+        other.chunks.clear();
+        other.count = 0;
+        other.allocated = 0;
+    }
+
+    return (*this);
+}
+
+void VarStorage::reserve(size_t n){
+    while (allocated < n){
+        allocateChunk();
+    }
+}
+
+void VarStorage::clear(){
+    chunks.clear();
+    count = 0;
+    allocated = 0;
+}
+
+void VarStorage::allocateChunk(){
+    size_t chunk_size = size_t(1) << (FIRST_CHUNK_SHIFT + chunks.size());
+
+    chunks.emplace_back();
+    chunks.back().reserve(chunk_size); // Reserved once, the chunk never grows past this size so it is never reallocated
+    allocated += chunk_size;
+}
+
+}
@@ -0,0 +1,175 @@
+#ifndef _VARSTORAGE_HPP
+#define _VARSTORAGE_HPP
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+
+#include "Var.hpp"
+
+namespace Osi2 {
+
+/*! \brief Container of Var with stable addresses
+
+    Terms of expressions hold references to the Var stored in a Model, so the storage must never move a Var once it is created.
+    The Var are stored in chunks of geometrically increasing sizes (16, 32, 64, ...) that are never reallocated : adding variables
+    only allocates new chunks, and the existing Var (and any reference to them) stay where they are.
+    Random access stays constant time, the chunk holding an index is found with a base 2 logarithm.
+ */
+class VarStorage {
+    public:
+
+        /// Random access iterator over the stored Var
+        template <typename V, typename S>
+        class Iterator {
+            public:
+                typedef std::random_access_iterator_tag iterator_category;
+                typedef V value_type;
+                typedef std::ptrdiff_t difference_type;
+                typedef V* pointer;
+                typedef V& reference;
+
+                Iterator() : storage(nullptr), index(0) {}
+                Iterator(S* s, size_t i) : storage(s), index(i) {}
+
+                V& operator*() const { return (*storage)[index]; }
+                V* operator->() const { return &(*storage)[index]; }
+                V& operator[](std::ptrdiff_t n) const { return (*storage)[index + n]; }
+
+                Iterator& operator++() { ++index; return *this; }
+                Iterator operator++(int) { Iterator ret_val(*this); ++index; return ret_val; }
+                Iterator& operator--() { --index; return *this; }
+                Iterator operator--(int) { Iterator ret_val(*this); --index; return ret_val; }
+                Iterator& operator+=(std::ptrdiff_t n) { index += n; return *this; }
+                Iterator& operator-=(std::ptrdiff_t n) { index -= n; return *this; }
+                Iterator operator+(std::ptrdiff_t n) const { return Iterator(storage, index + n); }
+                Iterator operator-(std::ptrdiff_t n) const { return Iterator(storage, index - n); }
+                std::ptrdiff_t operator-(const Iterator& other) const { return (std::ptrdiff_t)index - (std::ptrdiff_t)other.index; }
+
+                bool operator==(const Iterator& other) const { return index == other.index; }
+                bool operator!=(const Iterator& other) const { return index != other.index; }
+                bool operator<(const Iterator& other) const { return index < other.index; }
+                bool operator>(const Iterator& other) const { return index > other.index; }
+                bool operator<=(const Iterator& other) const { return index <= other.index; }
+                bool operator>=(const Iterator& other) const { return index >= other.index; }
+
+            private:
+                S* storage;
+                size_t index;
+        };
+
+        typedef Iterator<Var, VarStorage> iterator;
+        typedef Iterator<const Var, const VarStorage> const_iterator;
+
+        /// \name Constructors
+        //{@
+
+        /// Default constructor, does not allocate
+        VarStorage();
+
+        /// Copy constructor. The copied Var live at new addresses
+        VarStorage(const VarStorage& other);
+
+        /// Assignment operator. The copied Var live at new addresses
+        VarStorage& operator=(const VarStorage& other);
+
+        /// Move constructor. The Var keep their addresses
+        VarStorage(VarStorage&& other) noexcept;
+
+        /// Move assignment operator. The Var of other keep their addresses, the ones of this storage are destroyed
+        VarStorage& operator=(VarStorage&& other) noexcept;
+        //@}
+
+        /// \name Editing functions
+        //{@
+
+        /// Construct a Var at the end of the storage. Never moves the Var already stored
+        template <typename... Args>
+        Var& emplace_back(Args&&... args){
+            if (count == allocated){ // Every chunk is full, allocate the next one
+                allocateChunk();
+            }
+            std::vector<Var>& chunk = chunks[chunkOf(count)];
+            chunk.emplace_back(std::forward<Args>(args)...);
+            ++count;
+
+            return chunk.back();
+        }
+
+        /// Allocate all the chunks needed to hold n Var at once
+        void reserve(size_t n);
+
+        /// Remove all the Var and release the memory
+        void clear();
+        //@}
+
+        /// \name Getters
+        //{@
+
+        /// Get the Var at a given index
+        Var& operator[](size_t index) { return chunks[chunkOf(index)][offsetOf(index)]; }
+
+        /// Get the Var at a given index
+        const Var& operator[](size_t index) const { return chunks[chunkOf(index)][offsetOf(index)]; }
+
+        /// Get the last Var
+        Var& back() { return (*this)[count - 1]; }
+
+        /// Get the last Var
+        const Var& back() const { return (*this)[count - 1]; }
+
+        /// Get the number of Var stored
+        size_t size() const { return count; }
+
+        /// Get the number of Var that can be stored without allocating
+        size_t capacity() const { return allocated; }
+
+        /// Check if the storage is empty
+        bool empty() const { return count == 0; }
+        //@}
+
+        /// \name Iterator functions
+        //{@
+        iterator begin() { return iterator(this, 0); }
+        iterator end() { return iterator(this, count); }
+        const_iterator begin() const { return const_iterator(this, 0); }
+        const_iterator end() const { return const_iterator(this, count); }
+        //@}
+
+    private:
+        static const size_t FIRST_CHUNK_SHIFT = 4; ///< The first chunk holds 2^4 Var, each following one twice as much as the previous
+
+        /// Allocate the next chunk, twice as big as the last one
+        void allocateChunk();
+
+        /// Get the index of the chunk holding a given index
+        static size_t chunkOf(size_t index){
+            return log2((index >> FIRST_CHUNK_SHIFT) + 1);
+        }
+
+        /// Get the position of a given index inside its chunk
+        static size_t offsetOf(size_t index){
+            return index - (((size_t(1) << chunkOf(index)) - 1) << FIRST_CHUNK_SHIFT);
+        }
+
+        /// Floor of the base 2 logarithm of a non zero number
+        static size_t log2(size_t n){
+#if defined(__GNUC__)
+            return sizeof(unsigned long long) * 8 - 1 - __builtin_clzll(n);
+#else
+            size_t ret_val = 0;
+            while (n >>= 1) ++ret_val;
+            return ret_val;
+#endif
+        }
+
+        std::vector<std::vector<Var>> chunks; ///< Chunks of Var. Each one is reserved once to its full size and is never reallocated
+        size_t count; ///< Number of Var stored
+        size_t allocated; ///< Total capacity of the allocated chunks
+};
+
+}
+
+#endif // _VARSTORAGE_HPP
@@ -0,0 +1,94 @@
+/*! \brief Random access throughput of DCSRMatrix::getValue, against the former lookup
+
+    The former getValue copied the column indices of each segment of the row into a temporary vector and ran std::find on it.
+    It is reproduced here through RowView, and compared with getValue on random (row, column) pairs, half of them stored elements,
+    for rows of 8 to 512 elements : defragmented (one sorted segment, binary search) and fragmented by setValue (per segment search).
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "DCSRMatrix.hpp"
+
+using namespace Osi2;
+
+namespace {
+
+double now(){
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/// The getValue of the first version : a copy of the column indices of each segment, then std::find
+double formerGetValue(const DCSRMatrix& m, uint32_t i, uint32_t j){
+    DCSRMatrix::RowView row = m.getRowView(i);
+    for (size_t s = 0; s < row.segmentCount(); s++){
+        Span<uint32_t> indices = row.segmentIndices(s);
+        std::vector<uint32_t> col(indices.begin(), indices.end());
+        auto e = std::find(col.begin(), col.end(), j);
+        if (e != col.end()){
+            return row.segmentValues(s)[e - col.begin()];
+        }
+    }
+    return 0;
+}
+
+/// Millions of lookups per second
+template <typename F>
+double throughput(const std::vector<std::pair<uint32_t, uint32_t>>& keys, F lookup){
+    double start = now();
+    double sum = 0;
+    for (const auto& k : keys){
+        sum += lookup(k.first, k.second);
+    }
+    double ret_val = keys.size() / (now() - start) * 1e-6;
+    if (sum == -1){ // Keeps the lookups from being optimized away
+        std::printf("%f\n", sum);
+    }
+    return ret_val;
+}
+
+}
+
+int main(){
+    const uint32_t ROWS = 20000;
+    const size_t LOOKUPS = 2000000;
+
+    std::printf("%8s %12s %14s %14s %8s\n", "row nnz", "layout", "former Ml/s", "getValue Ml/s", "speedup");
+    for (uint32_t row_nnz : {8, 64, 512}){
+        uint32_t cols = 4 * row_nnz;
+        std::mt19937 rng(row_nnz);
+        std::vector<uint32_t> rows, col_indices;
+        std::vector<double> values;
+        for (uint32_t i = 0; i < ROWS; i++){
+            for (uint32_t k = 0; k < row_nnz; k++){ // Every fourth column, so that half the lookups below miss
+                rows.push_back(i);
+                col_indices.push_back(4 * k + rng() % 4);
+                values.push_back(1.0 + k);
+            }
+        }
+        DCSRMatrix m = DCSRMatrix::fromTriplets(rows, col_indices, values, ROWS, cols);
+
+        std::vector<std::pair<uint32_t, uint32_t>> keys(LOOKUPS);
+        for (auto& k : keys){
+            size_t e = rng() % values.size();
+            k = rng() % 2 == 0 ? std::make_pair(rows[e], col_indices[e]) : std::make_pair(uint32_t(rng() % ROWS), uint32_t(rng() % cols));
+        }
+
+        for (int layout = 0; layout < 2; layout++){
+            if (layout == 1){ // Grow a quarter of the rows past their slack, so that they get a second segment
+                for (uint32_t i = 0; i < ROWS; i += 4){
+                    for (uint32_t k = 0; k < row_nnz / 2 + 1; k++){
+                        m.setValue(i, cols + k, 1.0);
+                    }
+                }
+            }
+            double former = throughput(keys, [&m](uint32_t i, uint32_t j){ return formerGetValue(m, i, j); });
+            double current = throughput(keys, [&m](uint32_t i, uint32_t j){ return m.getValue(i, j); });
+            std::printf("%8u %12s %14.2f %14.2f %7.1fx\n", row_nnz, layout == 0 ? "defragmented" : "fragmented", former, current, current / former);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,68 @@
+/*! \brief Memory and SpMV speed of the instantiations of BasicDCSRMatrix
+
+    The same random matrix (400k rows and columns, 25 elements per row) is built with fromTriplets as BasicDCSRMatrix<uint32_t, double>
+    (DCSRMatrix), <uint64_t, double> and <uint32_t, float>. For each one : the memory of the arrays from stats(), and the GFLOP/s of
+    multiply on the default number of threads, best of several runs.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "DCSRMatrix.hpp"
+
+using namespace Osi2;
+
+namespace {
+
+double now(){
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/// Build the matrix of the triplets with the given types, and print its memory and multiply speed
+template <typename Index, typename Value>
+void run(const char* name, const std::vector<uint32_t>& rows, const std::vector<uint32_t>& cols, const std::vector<double>& values, size_t n){
+    std::vector<Index> typed_rows(rows.begin(), rows.end());
+    std::vector<Index> typed_cols(cols.begin(), cols.end());
+    std::vector<Value> typed_values(values.begin(), values.end());
+    BasicDCSRMatrix<Index, Value> m = BasicDCSRMatrix<Index, Value>::fromTriplets(typed_rows, typed_cols, typed_values, n, n);
+
+    typename BasicDCSRMatrix<Index, Value>::Stats stats = m.stats();
+    double mb = (stats.col_indices_bytes + stats.values_bytes + stats.row_indices_bytes) / 1e6;
+
+    std::vector<Value> x(n, Value(1)), y;
+    m.multiply(x, y);
+    double best = 1e30;
+    for (int r = 0; r < 10; r++){
+        double start = now();
+        m.multiply(x, y);
+        best = std::min(best, now() - start);
+    }
+    std::printf("%20s %10.1f MB %10.2f B/nnz %10.2f GFLOP/s\n", name, mb, mb * 1e6 / stats.nnz, 2.0 * stats.nnz / best * 1e-9);
+}
+
+}
+
+int main(){
+    const uint32_t N = 400000;
+    const uint32_t ROW_NNZ = 25;
+
+    std::mt19937 rng(16);
+    std::vector<uint32_t> rows, cols;
+    std::vector<double> values;
+    for (uint32_t i = 0; i < N; i++){
+        for (uint32_t k = 0; k < ROW_NNZ; k++){
+            rows.push_back(i);
+            cols.push_back(rng() % N);
+            values.push_back(1.0 + rng() % 100);
+        }
+    }
+
+    std::printf("%20s %13s %14s %18s\n", "instantiation", "memory", "per element", "multiply");
+    run<uint32_t, double>("<uint32_t, double>", rows, cols, values, N);
+    run<uint64_t, double>("<uint64_t, double>", rows, cols, values, N);
+    run<uint32_t, float>("<uint32_t, float>", rows, cols, values, N);
+    return 0;
+}
@@ -0,0 +1,74 @@
+/*! \brief Cost of the lookups of Model as the model grows
+
+    Random lookups of variables by id and by name, of constraints by name, and of names that are not in the model, on models of
+    10k to 500k variables and constraints. The time per lookup must stay about flat : the remaining growth comes from cache misses.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Model.hpp"
+
+using namespace Osi2;
+
+namespace {
+
+double now(){
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/// Nanoseconds per call of lookup(k), for k in keys
+template <typename Key, typename F>
+double nsPerLookup(const std::vector<Key>& keys, F lookup){
+    double start = now();
+    size_t found = 0;
+    for (const auto& k : keys){
+        found += lookup(k);
+    }
+    double ret_val = (now() - start) * 1e9 / keys.size();
+    if (found == 0){ // Keeps the lookups from being optimized away
+        std::printf("nothing found\n");
+    }
+    return ret_val;
+}
+
+}
+
+int main(){
+    const size_t LOOKUPS = 1000000;
+    std::mt19937 rng(1);
+
+    std::printf("%8s %12s %12s %16s %12s\n", "size", "var by id", "var by name", "constr by name", "name miss");
+    for (size_t n : {10000, 100000, 500000}){
+        Model m;
+        std::vector<uint32_t> ids(n);
+        for (size_t j = 0; j < n; j++){
+            ids[j] = m.addVariable("x" + std::to_string(j));
+        }
+        for (size_t i = 0; i < n; i++){
+            PackedVector coefs;
+            coefs.append(i, 1.0);
+            coefs.seal();
+            m.addConstraint(coefs, Range(0, 1), "c" + std::to_string(i));
+        }
+
+        std::vector<uint32_t> id_keys(LOOKUPS);
+        std::vector<std::string> var_keys(LOOKUPS), constr_keys(LOOKUPS), missing_keys(LOOKUPS);
+        for (size_t k = 0; k < LOOKUPS; k++){
+            id_keys[k] = ids[rng() % n];
+            var_keys[k] = "x" + std::to_string(rng() % n);
+            constr_keys[k] = "c" + std::to_string(rng() % n);
+            missing_keys[k] = "c" + std::to_string(n + rng() % n);
+        }
+
+        double by_id = nsPerLookup(id_keys, [&m](uint32_t id){ return m[id].getID() != 0; });
+        double by_name = nsPerLookup(var_keys, [&m](const std::string& name){ return m[name].getID() != 0; });
+        double constr = nsPerLookup(constr_keys, [&m](const std::string& name){ return m(name).getID() != 0; });
+        double miss = nsPerLookup(missing_keys, [&m](const std::string& name){ return !m.hasConstraint(name); });
+        std::printf("%8zu %9.0f ns %9.0f ns %13.0f ns %9.0f ns\n", n, by_id, by_name, constr, miss);
+    }
+    return 0;
+}
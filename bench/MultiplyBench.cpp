@@ -0,0 +1,90 @@
+/*! \brief GFLOP/s of DCSRMatrix::multiply and transposeMultiply against the thread count
+
+    A random matrix of 400k rows and columns with 25 elements per row, defragmented then with a quarter of its rows grown past
+    their slack by setValue (two segments each). setThreadCount goes from 1 to twice the hardware threads, and each kernel is
+    timed on its best of several runs. A product does 2 flops per element.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "DCSRMatrix.hpp"
+#include "Parallel.hpp"
+
+using namespace Osi2;
+
+namespace {
+
+double now(){
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/// Best time of a few runs of f, after a first one that warms the caches and the thread pool
+template <typename F>
+double bestTime(F f){
+    f();
+    double ret_val = 1e30;
+    for (int r = 0; r < 5; r++){
+        double start = now();
+        f();
+        ret_val = std::min(ret_val, now() - start);
+    }
+    return ret_val;
+}
+
+}
+
+int main(){
+    const uint32_t N = 400000;
+    const uint32_t ROW_NNZ = 25;
+
+    std::mt19937 rng(12);
+    std::vector<uint32_t> rows, cols;
+    std::vector<double> values;
+    for (uint32_t i = 0; i < N; i++){
+        for (uint32_t k = 0; k < ROW_NNZ; k++){
+            rows.push_back(i);
+            cols.push_back(rng() % N);
+            values.push_back(1.0 + k);
+        }
+    }
+    DCSRMatrix m = DCSRMatrix::fromTriplets(rows, cols, values, N, N);
+    size_t nnz = m.stats().nnz;
+
+    setThreadCount(0);
+    size_t hardware = threadCount();
+    std::vector<size_t> counts;
+    for (size_t t = 1; t < 2 * hardware; t *= 2){
+        counts.push_back(t);
+    }
+    if (std::find(counts.begin(), counts.end(), hardware) == counts.end()){
+        counts.push_back(hardware);
+    }
+    counts.push_back(2 * hardware);
+    std::sort(counts.begin(), counts.end());
+
+    std::vector<double> x(N, 1.0), u(N, 0.5), y, z;
+    std::printf("%zu elements, %zu hardware threads\n", nnz, hardware);
+    std::printf("%14s %8s %14s %14s\n", "layout", "threads", "A x GFLOP/s", "A^T u GFLOP/s");
+    for (int layout = 0; layout < 2; layout++){
+        if (layout == 1){
+            for (uint32_t i = 0; i < N; i += 4){
+                for (uint32_t k = 0; k < ROW_NNZ / 2; k++){
+                    m.setValue(i, rng() % N, 2.0);
+                }
+            }
+            nnz = m.stats().nnz;
+        }
+        for (size_t t : counts){
+            setThreadCount(t);
+            double multiply = bestTime([&]{ m.multiply(x, y); });
+            double transpose = bestTime([&]{ m.transposeMultiply(u, z); });
+            std::printf("%14s %8zu %14.2f %14.2f\n", layout == 0 ? "defragmented" : "fragmented", t, 2.0 * nnz / multiply * 1e-9, 2.0 * nnz / transpose * 1e-9);
+        }
+    }
+    setThreadCount(0);
+    return 0;
+}
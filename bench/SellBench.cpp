@@ -0,0 +1,85 @@
+/*! \brief SpMV of SellMatrix against DCSRMatrix::multiply (plain CSR) across row length distributions
+
+    Matrices of 400k rows and columns whose row lengths are uniform (25), uniform in [1, 50], power law, or 90% of 4 and 10% of
+    200 elements. Each one is timed with DCSRMatrix::multiply and with SellMatrix::multiply for sigma = 1 (no sorting) and
+    sigma = 256, best of several runs on the default number of threads. The fill is the fraction of the SELL slots that hold an
+    element. The largest relative difference with the CSR result is printed too.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "DCSRMatrix.hpp"
+#include "SellMatrix.hpp"
+
+using namespace Osi2;
+
+namespace {
+
+double now(){
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/// Best time of several runs of f
+template <typename F>
+double bestTime(F f){
+    f();
+    double ret_val = 1e30;
+    for (int r = 0; r < 10; r++){
+        double start = now();
+        f();
+        ret_val = std::min(ret_val, now() - start);
+    }
+    return ret_val;
+}
+
+}
+
+int main(){
+    const size_t N = 400000;
+    const char* names[] = {"uniform 25", "uniform 1-50", "power law", "90% 4 / 10% 200"};
+
+    std::printf("%-16s %9s %10s %16s %18s %8s %8s\n", "rows", "nnz", "CSR ms", "SELL-8-1 ms/fill", "SELL-8-256 ms/fill", "speedup", "diff");
+    for (int dist = 0; dist < 4; dist++){
+        std::mt19937 rng(dist);
+        std::vector<uint32_t> rows, cols;
+        std::vector<double> values;
+        for (size_t i = 0; i < N; i++){
+            size_t length = 0;
+            switch (dist){
+                case 0: length = 25; break;
+                case 1: length = 1 + rng() % 50; break;
+                case 2: length = std::min<size_t>(N, size_t(2.0 / std::pow((rng() % 100000 + 1) / 100000.0, 0.8))); break;
+                default: length = rng() % 10 == 0 ? 200 : 4; break;
+            }
+            for (size_t k = 0; k < length; k++){
+                rows.push_back(i);
+                cols.push_back(rng() % N);
+                values.push_back((rng() % 1000) / 100.0 - 5);
+            }
+        }
+        DCSRMatrix m = DCSRMatrix::fromTriplets(rows, cols, values, N, N);
+        SellMatrix unsorted(m, 1), sorted(m, 256);
+
+        std::vector<double> x(N), y_csr, y_unsorted, y_sorted;
+        for (auto& v : x){
+            v = (rng() % 1000) / 333.0;
+        }
+        double csr = bestTime([&]{ m.multiply(x, y_csr); });
+        double sell_unsorted = bestTime([&]{ unsorted.multiply(x, y_unsorted); });
+        double sell_sorted = bestTime([&]{ sorted.multiply(x, y_sorted); });
+
+        double diff = 0;
+        for (size_t i = 0; i < N; i++){
+            diff = std::max(diff, std::max(std::abs(y_csr[i] - y_unsorted[i]), std::abs(y_csr[i] - y_sorted[i])) / (1 + std::abs(y_csr[i])));
+        }
+        size_t nnz = sorted.getElementCount();
+        std::printf("%-16s %9zu %10.2f %10.2f %5.2f %12.2f %5.2f %8.2f %8.1e\n", names[dist], nnz, csr * 1e3,
+                    sell_unsorted * 1e3, double(nnz) / unsorted.getSlotCount(), sell_sorted * 1e3, double(nnz) / sorted.getSlotCount(), csr / sell_sorted, diff);
+    }
+    return 0;
+}
@@ -57,6 +57,9 @@ void exampleModelBuilding(){
     m.addObjectiveFun("Objective1", e2, Objective::Type::MINIMIZE); // Add an objective function to the model
     m.addObjectiveFun("Objective2", e3, Objective::Type::MINIMIZE); // Add an other objective function to the model
 
+    LinearExpr e4 = quicksum(m.varsBegin(), m.varsEnd(), [](const Var& v){ return v.getRanges()[0].upper_bound; }); // Summation notation over all the variables of the model
+    m.addObjectiveFun("Objective3", e4, Objective::Type::MAXIMIZE);
+
     m.display(); // Display the model on standard output. Mainly, for debugging purpose
 }
 
@@ -0,0 +1,518 @@
+/*! \brief Consistency of DCSRMatrix with a dense reference
+
+    Random sequences of addRow, addColumn, setValue, removeEntry, removeRow, removeColumn, defragment and column index builds
+    are applied both to a DCSRMatrix and to a dense matrix, on 1 to 3 threads. After each sequence, and again after an incremental
+    and a full defragment, getValue, multiply, transposeMultiply, the column index and toTriplets must match the dense matrix.
+    Explicit zeros are stored by addRow and addColumn as tombstones, which no read may see. fromTriplets is checked on unsorted
+    triplets with duplicates, and through the round trip with toTriplets. The values are small integers, exact in float too, so
+    every instantiation of BasicDCSRMatrix is checked the same way. The products of SellMatrix must match DCSRMatrix::multiply.
+    Rows appended by concurrentAddRow from several threads must give the matrix of addRow in the order of the returned indices,
+    and a failed append, made by an operator new that refuses large blocks, must make seal() throw and leave the matrix as it was.
+ */
+
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "DCSRMatrix.hpp"
+#include "Parallel.hpp"
+#include "SellMatrix.hpp"
+
+namespace {
+
+std::atomic<bool> refuse_large_blocks(false); ///< When set, operator new throws std::bad_alloc for blocks of 1 MB or more
+
+}
+
+void* operator new(size_t size){
+    if (size >= (size_t(1) << 20) && refuse_large_blocks){
+        throw std::bad_alloc();
+    }
+    void* ret_val = std::malloc(size == 0 ? 1 : size);
+    if (ret_val == nullptr){
+        throw std::bad_alloc();
+    }
+    return ret_val;
+}
+
+void* operator new[](size_t size){
+    return operator new(size);
+}
+
+#if defined(__GNUC__) && !defined(__clang__) // Once inlined, GCC pairs the free below with the builtin operator new
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+using namespace Osi2;
+
+namespace {
+
+typedef std::vector<std::vector<double>> Dense;
+
+int failures = 0;
+
+/// Count a failed check, and print the first ones
+void check(bool condition, const std::string& what){
+    if (!condition){
+        if (failures < 10){
+            std::cout << "FAILED  " << what << std::endl;
+        }
+        ++failures;
+    }
+}
+
+/// Compare two matrices through their dimensions and their elements
+void compareMatrices(const DCSRMatrix& m, const DCSRMatrix& expected, const std::string& when){
+    check(m.getRowCount() == expected.getRowCount() && m.getColumnCount() == expected.getColumnCount(), when + " : dimensions");
+    std::vector<uint32_t> rows, cols, expected_rows, expected_cols;
+    std::vector<double> values, expected_values;
+    m.toTriplets(rows, cols, values);
+    expected.toTriplets(expected_rows, expected_cols, expected_values);
+    check(rows == expected_rows && cols == expected_cols && values == expected_values, when + " : elements");
+}
+
+/// Compare every read of the matrix with the dense reference
+template <typename Index, typename Value>
+void compare(const BasicDCSRMatrix<Index, Value>& m, const Dense& d, size_t cols, const std::string& when){
+    check(m.getRowCount() == d.size(), when + " : row count");
+    check(m.getColumnCount() == cols, when + " : column count");
+    if (m.getRowCount() != d.size() || m.getColumnCount() != cols){
+        return;
+    }
+
+    for (size_t i = 0; i < d.size(); i++){
+        for (size_t j = 0; j < cols; j++){
+            check(m.getValue(i, j) == d[i][j], when + " : getValue(" + std::to_string(i) + ", " + std::to_string(j) + ")");
+        }
+    }
+
+    std::vector<Value> x(cols), y;
+    for (size_t j = 0; j < cols; j++){
+        x[j] = 1.0 + j % 3;
+    }
+    m.multiply(x, y);
+    for (size_t i = 0; i < d.size(); i++){
+        double sum = 0;
+        for (size_t j = 0; j < cols; j++){
+            sum += d[i][j] * x[j];
+        }
+        check(std::abs(sum - y[i]) < 1e-9, when + " : multiply, row " + std::to_string(i));
+    }
+
+    std::vector<Value> u(d.size()), z;
+    for (size_t i = 0; i < d.size(); i++){
+        u[i] = 2.0 - i % 4;
+    }
+    m.transposeMultiply(u, z);
+    for (size_t j = 0; j < cols; j++){
+        double sum = 0;
+        for (size_t i = 0; i < d.size(); i++){
+            sum += d[i][j] * u[i];
+        }
+        check(std::abs(sum - z[j]) < 1e-9, when + " : transposeMultiply, column " + std::to_string(j));
+    }
+
+    size_t nnz = 0;
+    for (size_t j = 0; j < cols; j++){ // The column index holds the non zero elements only, sorted by row
+        typename BasicDCSRMatrix<Index, Value>::ColumnView column = m.getColumnView(j);
+        size_t column_nnz = 0;
+        for (size_t i = 0; i < d.size(); i++){
+            column_nnz += d[i][j] != 0 ? 1 : 0;
+        }
+        nnz += column_nnz;
+        check(column.size() == column_nnz, when + " : getColumnView(" + std::to_string(j) + ").size()");
+        for (size_t k = 0; k < column.size(); k++){
+            check(column[k].first < d.size() && d[column[k].first][j] == column[k].second && (k == 0 || column[k - 1].first < column[k].first),
+                  when + " : getColumnView(" + std::to_string(j) + ") element " + std::to_string(k));
+        }
+    }
+
+    std::vector<Index> rows, col_indices;
+    std::vector<Value> values;
+    m.toTriplets(rows, col_indices, values);
+    check(values.size() == nnz, when + " : toTriplets element count");
+    for (size_t k = 0; k < values.size(); k++){
+        check(d[rows[k]][col_indices[k]] == values[k], when + " : toTriplets element " + std::to_string(k));
+    }
+}
+
+/// fromTriplets on unsorted triplets with duplicates and sums equal to zero, and the round trip through toTriplets
+template <typename Index, typename Value>
+void checkTriplets(std::mt19937& rng, const std::string& type){
+    for (int round = 0; round < 12; round++){
+        setThreadCount(1 + round % 3);
+        bool large = round >= 9; // Enough triplets for the sort to run on several threads
+        uint32_t nb_rows = large ? 600 : 1 + rng() % 30;
+        uint32_t nb_cols = large ? 600 : 1 + rng() % 30;
+        size_t count = large ? 200000 : rng() % 300;
+
+        std::vector<Index> rows, col_indices;
+        std::vector<Value> values;
+        Dense d(nb_rows, std::vector<double>(nb_cols, 0));
+        for (size_t k = 0; k < count; k++){ // Integer values, so that the sums do not depend on their order
+            uint32_t i = rng() % nb_rows;
+            uint32_t j = rng() % nb_cols;
+            double x = double(int(rng() % 9) - 4);
+            rows.push_back(i);
+            col_indices.push_back(j);
+            values.push_back(x);
+            d[i][j] += x;
+            if (rng() % 8 == 0){ // A duplicate that cancels the sum so far
+                rows.push_back(i);
+                col_indices.push_back(j);
+                values.push_back(-d[i][j]);
+                d[i][j] = 0;
+            }
+        }
+
+        std::string name = type + "fromTriplets round " + std::to_string(round);
+        BasicDCSRMatrix<Index, Value> m = BasicDCSRMatrix<Index, Value>::fromTriplets(rows, col_indices, values, nb_rows, nb_cols);
+        compare(m, d, nb_cols, name);
+
+        std::vector<Index> out_rows, out_cols;
+        std::vector<Value> out_values;
+        m.toTriplets(out_rows, out_cols, out_values);
+        bool ordered = true;
+        for (size_t k = 1; k < out_rows.size(); k++){
+            ordered = ordered && (out_rows[k - 1] < out_rows[k] || (out_rows[k - 1] == out_rows[k] && out_cols[k - 1] < out_cols[k]));
+        }
+        check(ordered, name + " : toTriplets sorted by row then column");
+
+        BasicDCSRMatrix<Index, Value> back = BasicDCSRMatrix<Index, Value>::fromTriplets(out_rows, out_cols, out_values, nb_rows, nb_cols);
+        compare(back, d, nb_cols, name + " after the round trip");
+    }
+}
+
+/// SellMatrix::multiply against DCSRMatrix::multiply, on fragmented matrices with explicit zeros, and with infinite and NaN elements in x
+void checkSell(std::mt19937& rng){
+    for (int round = 0; round < 40; round++){
+        setThreadCount(1 + round % 3);
+        bool large = round >= 36; // Enough slots for the product to run on several threads
+        uint32_t nb_rows = large ? 20000 : 1 + rng() % 100;
+        uint32_t nb_cols = large ? 100 : 1 + rng() % 60;
+        bool zeros = round % 2 == 0; // DCSRMatrix::multiply multiplies its explicit zeros too, so they are left out of the NaN checks
+
+        DCSRMatrix m;
+        for (uint32_t i = 0; i < nb_rows; i++){
+            PackedVector v;
+            for (uint32_t j = rng() % 4; j < nb_cols; j += 1 + rng() % (rng() % 2 == 0 ? 3 : 40)){
+                int value = int(rng() % 8) - 4; // Not 0
+                v.append(j, zeros && rng() % 6 == 0 ? 0.0 : double(value >= 0 ? value + 1 : value));
+            }
+            v.seal();
+            m.addRow(v);
+        }
+        for (int k = nb_rows / 10; k > 0; k--){ // Second segments
+            m.setValue(rng() % nb_rows, rng() % nb_cols, 1.0 + rng() % 3);
+        }
+        if (m.getColumnCount() == 0){
+            continue;
+        }
+
+        std::string name = "SellMatrix round " + std::to_string(round);
+        for (size_t sigma : {1, 4, 256}){
+            SellMatrix sell(m, sigma);
+            check(sell.getRowCount() == m.getRowCount() && sell.getColumnCount() == m.getColumnCount(), name + " : dimensions");
+
+            for (int special = 0; special < (zeros ? 1 : 4); special++){
+                std::vector<double> x(m.getColumnCount()), y, z;
+                for (auto& v : x){
+                    v = double(int(rng() % 7) - 3);
+                }
+                if (special != 0){ // The padding uses column 0, which must not spread an infinite or NaN value to the padded rows
+                    x[0] = special == 1 ? INFINITY : special == 2 ? -INFINITY : NAN;
+                    x[x.size() / 2] = x[0];
+                }
+                m.multiply(x, y);
+                sell.multiply(x, z);
+                bool same = y.size() == z.size();
+                for (size_t i = 0; same && i < y.size(); i++){ // Integer values : the sums are exact, whatever their order
+                    same = y[i] == z[i] || (std::isnan(y[i]) && std::isnan(z[i]));
+                }
+                check(same, name + " : multiply, sigma " + std::to_string(sigma) + ", special x " + std::to_string(special));
+            }
+        }
+    }
+}
+
+/// A random row of up to max_length elements, with explicit zeros sometimes
+PackedVector randomRow(std::mt19937& rng, uint32_t max_length){
+    PackedVector ret_val;
+    uint32_t j = rng() % 4;
+    for (uint32_t k = rng() % (max_length + 1); k > 0; k--){
+        ret_val.append(j, rng() % 7 == 0 ? 0.0 : 1.0 + rng() % 9);
+        j += 1 + rng() % 5;
+    }
+    ret_val.seal();
+    return ret_val;
+}
+
+/// concurrentAddRow from several threads then seal, against addRow in the order of the returned indices. Then a failed append
+void checkConcurrentAppend(std::mt19937& rng){
+    for (int round = 0; round < 4; round++){
+        setThreadCount(1 + round % 3); // Threads of the copy made by seal
+        size_t thread_count = 2 + round % 3;
+        size_t rows_per_thread = round < 2 ? 2000 : 25000; // The last rounds span several row chunks and slot chunks
+
+        DCSRMatrix m, expected;
+        for (int k = rng() % 5; k > 0; k--){ // Rows already in the matrix
+            PackedVector v = randomRow(rng, 10);
+            m.addRow(v);
+            expected.addRow(v);
+        }
+        size_t base = m.getRowCount();
+
+        std::vector<std::vector<PackedVector>> rows(thread_count);
+        std::vector<std::vector<uint32_t>> indices(thread_count);
+        for (auto& thread_rows : rows){
+            for (size_t k = 0; k < rows_per_thread; k++){
+                thread_rows.push_back(randomRow(rng, 20));
+            }
+        }
+
+        m.beginConcurrentAppend();
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < thread_count; t++){
+            threads.emplace_back([&m, &rows, &indices, t](){
+                for (const auto& v : rows[t]){
+                    indices[t].push_back(m.concurrentAddRow(v));
+                }
+            });
+        }
+        for (auto& thread : threads){
+            thread.join();
+        }
+        m.seal();
+
+        std::vector<const PackedVector*> by_index(thread_count * rows_per_thread, nullptr);
+        bool valid = true;
+        for (size_t t = 0; t < thread_count; t++){
+            for (size_t k = 0; k < rows_per_thread; k++){
+                size_t i = indices[t][k] - base;
+                valid = valid && indices[t][k] >= base && i < by_index.size() && by_index[i] == nullptr;
+                if (valid){
+                    by_index[i] = &rows[t][k];
+                }
+            }
+        }
+        std::string name = "concurrent append round " + std::to_string(round);
+        check(valid, name + " : each row gets its own index");
+        if (!valid){
+            continue;
+        }
+        for (const PackedVector* v : by_index){
+            expected.addRow(*v);
+        }
+        compareMatrices(m, expected, name);
+        m.defragment(true);
+        compareMatrices(m, expected, name + " after full defragment");
+    }
+
+    DCSRMatrix m; // An append that can not allocate its chunk : seal drops every appended row
+    for (int k = 0; k < 3; k++){
+        m.addRow(randomRow(rng, 10));
+    }
+    std::vector<uint32_t> rows_before, cols_before;
+    std::vector<double> values_before;
+    m.toTriplets(rows_before, cols_before, values_before);
+    size_t cols_count = m.getColumnCount();
+
+    PackedVector large; // Longer than a slot chunk, so that it needs a new one
+    for (uint32_t j = 0; j < 300000; j++){
+        large.append(j, 1.0);
+    }
+    large.seal();
+
+    m.beginConcurrentAppend();
+    std::thread other([&m, &rng](){
+        for (int k = 0; k < 100; k++){
+            m.concurrentAddRow(randomRow(rng, 10));
+        }
+    });
+    other.join();
+    bool append_threw = false;
+    refuse_large_blocks = true;
+    try{
+        m.concurrentAddRow(large);
+    }
+    catch (const std::bad_alloc&){
+        append_threw = true;
+    }
+    refuse_large_blocks = false;
+    check(append_threw, "failed append : concurrentAddRow throws");
+
+    bool seal_threw = false;
+    try{
+        m.seal();
+    }
+    catch (const std::runtime_error&){
+        seal_threw = true;
+    }
+    check(seal_threw, "failed append : seal throws");
+    std::vector<uint32_t> rows_after, cols_after;
+    std::vector<double> values_after;
+    m.toTriplets(rows_after, cols_after, values_after);
+    check(m.getRowCount() == 3 && m.getColumnCount() == cols_count && rows_after == rows_before && cols_after == cols_before && values_after == values_before,
+          "failed append : the matrix is left as before beginConcurrentAppend");
+
+    m.beginConcurrentAppend(); // The append mode can be used again
+    m.concurrentAddRow(randomRow(rng, 10));
+    m.seal();
+    check(m.getRowCount() == 4, "failed append : a new append works");
+}
+
+/// Random sequences of edits, applied to a matrix and to a dense reference
+template <typename Matrix>
+void checkSequences(std::mt19937& rng, int count, const std::string& type){
+    for (int sequence = 0; sequence < count; sequence++){
+        setThreadCount(1 + rng() % 3);
+        Matrix m;
+        Dense d;
+        size_t cols = 0;
+
+        auto growRows = [&](size_t n){
+            while (d.size() < n){
+                d.push_back(std::vector<double>(cols, 0));
+            }
+        };
+        auto growCols = [&](size_t n){
+            if (n > cols){
+                cols = n;
+                for (auto& row : d){
+                    row.resize(cols, 0);
+                }
+            }
+        };
+
+        int operations = rng() % 80;
+        for (int o = 0; o < operations; o++){
+            int kind = rng() % 13;
+            if (kind < 2){ // Row, with explicit zeros sometimes
+                PackedVector v;
+                std::set<uint32_t> used;
+                uint32_t width = 1 + rng() % 20;
+                for (int k = rng() % 8; k > 0; k--){
+                    uint32_t j = rng() % width;
+                    if (used.insert(j).second){
+                        v.append(j, rng() % 5 == 0 ? 0.0 : 1.0 + rng() % 9);
+                    }
+                }
+                v.seal();
+                size_t i = d.size();
+                growRows(i + 1);
+                growCols(v.dimension());
+                m.addRow(v);
+                growCols(m.getColumnCount());
+                for (const auto& e : v){
+                    d[i][e.first] = e.second;
+                }
+            }
+            else if (kind < 4){ // Column, with explicit zeros sometimes, with or without a valid column index
+                if (rng() % 2 == 0 && cols != 0){
+                    m.getColumnView(0);
+                }
+                PackedVector c;
+                std::set<uint32_t> used;
+                for (int k = rng() % 5; k > 0; k--){
+                    uint32_t i = rng() % (d.size() + 2);
+                    if (used.insert(i).second){
+                        c.append(i, rng() % 3 == 0 ? 0.0 : 2.0 + rng() % 5);
+                    }
+                }
+                c.seal();
+                size_t j = cols;
+                growCols(j + 1);
+                growRows(c.dimension());
+                m.addColumn(c);
+                for (const auto& e : c){
+                    d[e.first][j] = e.second;
+                }
+            }
+            else if (kind < 7){ // Update, insertion or removal through setValue
+                uint32_t i = rng() % (d.size() + 2);
+                uint32_t j = rng() % (cols + 2);
+                double x = rng() % 4 == 0 ? 0 : 1.0 + rng() % 9;
+                if (x != 0){
+                    growRows(i + 1);
+                    growCols(j + 1);
+                }
+                if (i < d.size() && j < cols){
+                    d[i][j] = x;
+                }
+                m.setValue(i, j, x);
+            }
+            else if (kind < 9){
+                if (d.empty() || cols == 0){
+                    continue;
+                }
+                uint32_t i = rng() % d.size();
+                uint32_t j = rng() % cols;
+                bool had = d[i][j] != 0;
+                d[i][j] = 0;
+                check(m.removeEntry(i, j) == had, "removeEntry return value");
+            }
+            else if (kind < 10){
+                if (d.empty()){
+                    continue;
+                }
+                uint32_t i = rng() % d.size();
+                d.erase(d.begin() + i);
+                check(m.removeRow(i), "removeRow return value");
+            }
+            else if (kind < 11){
+                if (cols == 0){
+                    continue;
+                }
+                uint32_t j = rng() % cols;
+                for (auto& row : d){
+                    row.erase(row.begin() + j);
+                }
+                cols--;
+                check(m.removeColumn(j), "removeColumn return value");
+            }
+            else if (kind < 12){
+                m.defragment(rng() % 2);
+            }
+            else if (cols != 0){
+                m.getColumnView(rng() % cols);
+            }
+        }
+
+        std::string name = type + "sequence " + std::to_string(sequence);
+        compare(m, d, cols, name);
+        m.defragment();
+        compare(m, d, cols, name + " after defragment");
+        m.defragment(true);
+        compare(m, d, cols, name + " after full defragment");
+    }
+}
+
+}
+
+int main(){
+    std::mt19937 rng(17);
+
+    checkSequences<DCSRMatrix>(rng, 400, "");
+    checkTriplets<uint32_t, double>(rng, "");
+    checkSell(rng);
+    checkConcurrentAppend(rng);
+    checkSequences<BasicDCSRMatrix<uint64_t, double>>(rng, 150, "<uint64_t, double> "); // The other explicit instantiations
+    checkTriplets<uint64_t, double>(rng, "<uint64_t, double> ");
+    checkSequences<BasicDCSRMatrix<uint32_t, float>>(rng, 150, "<uint32_t, float> ");
+    checkTriplets<uint32_t, float>(rng, "<uint32_t, float> ");
+
+    std::cout << (failures == 0 ? "All checks passed" : std::to_string(failures) + " checks failed") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,239 @@
+/*! \brief Models written by ModelWriter : MPS read back by MpsReader, LP against a reference text
+
+    A model with every kind of row (E, L, G, ranged, free, empty) and of column (free, fixed, negative bounds, integer,
+    binary, without element) is written in MPS, from a stream and to a file, and read back by MpsReader : the model read must
+    be the one written. A large model with random coefficients checks the same through several flushes of the buffer, and that
+    the numbers read back exactly. A small model is written in LP and compared with the text it must give. The names that can
+    not be written in a format, among them the LP names that start with e or E followed by a digit, must throw.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Model.hpp"
+#include "ModelWriter.hpp"
+#include "MpsReader.hpp"
+
+using namespace Osi2;
+
+namespace {
+
+const double inf = std::numeric_limits<double>::infinity();
+
+int failures = 0;
+
+/// Count a failed check, and print the first ones
+void check(bool condition, const std::string& what){
+    if (!condition){
+        if (failures < 10){
+            std::cout << "FAILED  " << what << std::endl;
+        }
+        ++failures;
+    }
+}
+
+/// What a write must keep : the names and domains of the variables, the names of the constraints, the CSR arrays and the objective
+struct Snapshot {
+    std::vector<std::string> var_names;
+    std::vector<Var::Domaine> domains;
+    std::vector<std::string> constraint_names;
+    SparseMatrix csr;
+    bool maximize = false;
+};
+
+Snapshot snapshot(const Model& m, const std::string& objective){
+    Snapshot ret_val;
+    for (auto v = m.varsIteratorBegin(); v != m.varsIteratorEnd(); ++v){
+        ret_val.var_names.push_back(v->getName());
+        ret_val.domains.push_back(v->getDomaine());
+    }
+    for (auto c = m.constraintsIteratorBegin(); c != m.constraintsIteratorEnd(); ++c){
+        ret_val.constraint_names.push_back((*c)->getName());
+    }
+    ret_val.csr = m.toCSR(objective);
+    ret_val.maximize = m.getObjectiveFun(objective).type == Objective::Type::MAXIMIZE;
+    return ret_val;
+}
+
+bool operator==(const Snapshot& a, const Snapshot& b){
+    return a.var_names == b.var_names && a.domains == b.domains && a.constraint_names == b.constraint_names && a.maximize == b.maximize &&
+           a.csr.row_count == b.csr.row_count && a.csr.col_count == b.csr.col_count && a.csr.start == b.csr.start && a.csr.index == b.csr.index &&
+           a.csr.value == b.csr.value && a.csr.row_lower == b.csr.row_lower && a.csr.row_upper == b.csr.row_upper &&
+           a.csr.col_lower == b.csr.col_lower && a.csr.col_upper == b.csr.col_upper && a.csr.objective == b.csr.objective;
+}
+
+/// Add a linear constraint given its (variable index, coefficient) terms
+void addRow(Model& m, const std::vector<std::pair<uint32_t, double>>& terms, const Range& range, const std::string& name){
+    PackedVector coefs;
+    for (const auto& t : terms){
+        coefs.append(t.first, t.second);
+    }
+    coefs.seal();
+    m.addConstraint(coefs, range, name);
+}
+
+/// Add the objective function of a model given its (variable index, coefficient) terms
+void addObjective(Model& m, const std::vector<std::pair<uint32_t, double>>& terms, const std::string& name, Objective::Type type){
+    PackedVector coefs;
+    for (const auto& t : terms){
+        coefs.append(t.first, t.second);
+    }
+    coefs.seal();
+    m.addObjectiveFun(name, LinearExpr(coefs, m), type);
+}
+
+/// Write a model in MPS to a stream and to a file, read both back, and compare them with the model
+void checkRoundTrip(const Model& m, const std::string& objective, const std::string& name){
+    Snapshot expected = snapshot(m, objective);
+    ModelWriter writer(ModelWriter::Format::MPS);
+
+    std::ostringstream out;
+    writer.write(out, m, objective);
+    check(writer.getBytesWritten() == out.str().size(), name + " : bytes written");
+    Model from_stream;
+    std::istringstream in(out.str());
+    MpsReader reader;
+    reader.read(in, from_stream);
+    check(reader.getObjectiveName() == objective && snapshot(from_stream, objective) == expected, name + " : read back from a stream");
+
+    std::string path = (std::filesystem::temp_directory_path() / "ModelWriterTest.mps").string();
+    writer.write(path, m, objective);
+    Model from_file;
+    reader.read(path, from_file);
+    check(snapshot(from_file, objective) == expected, name + " : read back from a file");
+    std::remove(path.c_str());
+}
+
+/// Every kind of row and column, written in MPS and read back
+void checkMps(){
+    Model m;
+    uint32_t x = m.addVariable("x", Range(0, inf));
+    uint32_t y = m.addVariable("y", Range(-inf, inf));
+    uint32_t z = m.addVariable("z", Range(1, 10), Var::Domaine::INT);
+    uint32_t b = m.addVariable("b", Range(0, 1), Var::Domaine::BIN);
+    uint32_t w = m.addVariable("w", Range(2, 2));
+    uint32_t v = m.addVariable("v", Range(-inf, 5));
+    uint32_t u = m.addVariable("u", Range(-4, -1)); // A negative upper bound, written after the lower one
+    m.addVariable("n", Range(-3, 1e20)); // In no row
+    uint32_t e1 = m.addVariable("e1", Range(0, 4), Var::Domaine::INT); // An LP exponent, a valid MPS name
+    auto col = [&m](uint32_t id){ return uint32_t(m.getVariableIndex(m[id])); };
+
+    addRow(m, { { col(x), 1 }, { col(y), 2 }, { col(z), -1 } }, Range(-inf, 4), "le");
+    addRow(m, { { col(x), 0.1 }, { col(b), -1.0 / 3 } }, Range(1, inf), "ge");
+    addRow(m, { { col(w), 3 }, { col(v), 1e-300 } }, Range(7, 7), "eq");
+    addRow(m, { { col(x), 1 }, { col(y), 1 }, { col(u), 2 } }, Range(-2.5, 10), "ranged");
+    addRow(m, { { col(y), 1 }, { col(e1), 1 } }, Range(-inf, inf), "free");
+    addRow(m, {}, Range(0, 1), "empty");
+    addObjective(m, { { col(x), 2 }, { col(y), -1 }, { col(z), 0.5 }, { col(e1), 1 } }, "profit", Objective::Type::MAXIMIZE);
+    checkRoundTrip(m, "profit", "MPS round trip");
+
+    Model large; // Some MB of text, more than the buffer of the writer
+    std::mt19937 rng(25);
+    std::uniform_real_distribution<double> value(-1e3, 1e3);
+    const uint32_t COLS = 20000;
+    const uint32_t ROWS = 2000;
+    for (uint32_t j = 0; j < COLS; j++){
+        large.addVariable("col_" + std::to_string(j), j % 7 == 0 ? Range(-value(rng), inf) : Range(0, 1 + j % 5), j % 3 == 0 ? Var::Domaine::INT : Var::Domaine::REAL);
+    }
+    for (uint32_t i = 0; i < ROWS; i++){
+        std::vector<std::pair<uint32_t, double>> terms;
+        for (uint32_t j = i % 100; j < COLS; j += 100 + i % 7){
+            terms.push_back({ j, value(rng) });
+        }
+        double bound = value(rng);
+        addRow(large, terms, i % 3 == 0 ? Range(bound, bound) : i % 3 == 1 ? Range(-inf, bound) : Range(bound, bound + 10), "row_" + std::to_string(i));
+    }
+    std::vector<std::pair<uint32_t, double>> objective;
+    for (uint32_t j = 0; j < COLS; j += 2){
+        objective.push_back({ j, value(rng) });
+    }
+    addObjective(large, objective, "cost", Objective::Type::MINIMIZE);
+    checkRoundTrip(large, "cost", "large MPS round trip");
+}
+
+/// A small model written in LP, against the text it must give
+void checkLp(){
+    Model m;
+    uint32_t x = m.addVariable("x", Range(0, inf));
+    uint32_t y = m.addVariable("y", Range(-inf, inf));
+    uint32_t z = m.addVariable("z", Range(1, 10), Var::Domaine::INT);
+    uint32_t b = m.addVariable("b", Range(0, 1), Var::Domaine::BIN);
+    uint32_t w = m.addVariable("w", Range(2, 2));
+    uint32_t v = m.addVariable("v", Range(-inf, 5));
+    uint32_t ex = m.addVariable("ex1", Range(0, 3)); // e followed by a letter is a name
+    auto col = [&m](uint32_t id){ return uint32_t(m.getVariableIndex(m[id])); };
+
+    addRow(m, { { col(x), 1 }, { col(y), 2 }, { col(z), -1 } }, Range(-inf, 4), "c1");
+    addRow(m, { { col(x), -1 }, { col(b), 1 } }, Range(1, inf), "c2");
+    addRow(m, { { col(w), 3 }, { col(v), 0.25 } }, Range(7, 7), "c3");
+    addRow(m, { { col(x), 1 }, { col(ex), -1.5 } }, Range(0, 10), "c4");
+    addObjective(m, { { col(x), 2 }, { col(y), -1 }, { col(z), 0.5 } }, "profit", Objective::Type::MAXIMIZE);
+
+    const std::string expected =
+        "Maximize\n"
+        " profit: 2 x - y + 0.5 z\n"
+        "Subject To\n"
+        " c1: x + 2 y - z <= 4\n"
+        " c2: - x + b >= 1\n"
+        " c3: 3 w + 0.25 v = 7\n"
+        " c4: 0 <= x - 1.5 ex1 <= 10\n"
+        "Bounds\n"
+        " y free\n"
+        " 1 <= z <= 10\n"
+        " w = 2\n"
+        " -inf <= v <= 5\n"
+        " 0 <= ex1 <= 3\n"
+        "Generals\n"
+        " z\n"
+        "Binaries\n"
+        " b\n"
+        "End\n";
+    ModelWriter writer(ModelWriter::Format::LP);
+    std::ostringstream out;
+    writer.write(out, m, "profit");
+    check(out.str() == expected, "LP output :\n" + out.str());
+    check(writer.getBytesWritten() == expected.size(), "LP bytes written");
+}
+
+/// The names that can not be written must throw before anything is written
+void checkNames(){
+    struct { const char* name; bool mps, lp; } names[] = {
+        { "e1", true, false }, { "E2x", true, false }, { "e", true, true }, { "ex", true, true }, { "x1e2", true, true },
+        { "1a", true, false }, { ".a", true, false }, { "a b", false, false }, { "a:b", true, false } };
+    for (const auto& n : names){
+        for (ModelWriter::Format format : { ModelWriter::Format::MPS, ModelWriter::Format::LP }){
+            Model m;
+            m.addVariable(n.name, Range(0, 1));
+            std::ostringstream out;
+            bool written = true;
+            try{
+                ModelWriter(format).write(out, m);
+            }
+            catch (const std::invalid_argument&){
+                written = false;
+            }
+            bool valid = format == ModelWriter::Format::MPS ? n.mps : n.lp;
+            check(written == valid && (written || out.str().empty()),
+                  std::string("name \"") + n.name + "\" in " + (format == ModelWriter::Format::MPS ? "MPS" : "LP"));
+        }
+    }
+}
+
+}
+
+int main(){
+    checkMps();
+    checkLp();
+    checkNames();
+
+    std::cout << (failures == 0 ? "All checks passed" : std::to_string(failures) + " checks failed") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,131 @@
+/*! \brief Allocation counts of the copies and moves of expressions and constraints
+
+    The global operator new is replaced by one that counts the allocations : moving an expression or a constraint must take
+    over its storage and allocate nothing, where a copy allocates its terms again.
+ */
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+#include "Model.hpp"
+#include "LinearConstr.hpp"
+#include "QuadraticConstraint.hpp"
+
+namespace {
+
+std::atomic<size_t> allocations(0); ///< Number of calls to operator new
+int failures = 0;
+
+/// Print a check and count it if it fails
+void check(bool condition, const std::string& what, size_t count){
+    std::cout << (condition ? "ok      " : "FAILED  ") << what << " : " << count << " allocations" << std::endl;
+    if (!condition){
+        ++failures;
+    }
+}
+
+}
+
+void* operator new(size_t size){
+    ++allocations;
+    void* ret_val = std::malloc(size == 0 ? 1 : size);
+    if (ret_val == nullptr){
+        throw std::bad_alloc();
+    }
+    return ret_val;
+}
+
+void* operator new[](size_t size){
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+using namespace Osi2;
+
+int main(){
+    Model m;
+    m.addVariables(100);
+    LinearExpr e1, e2; // Larger than the inline storage of LinearExpr, so that a copy allocates
+    for (uint32_t i = 0; i < 50; i++){
+        e1.addTerm(i + 1.0, m.getVariableAtIndex(i));
+        e2.addTerm(i + 2.0, m.getVariableAtIndex(i + 50));
+    }
+
+    size_t before = allocations;
+    LinearExpr copied_expr(e1);
+    size_t copy = allocations - before;
+    before = allocations;
+    LinearExpr moved_expr(std::move(copied_expr));
+    size_t move = allocations - before;
+    check(copy > 0, "LinearExpr copy", copy);
+    check(move == 0, "LinearExpr move", move);
+
+    before = allocations;
+    LinearExpr assigned;
+    assigned = std::move(moved_expr);
+    move = allocations - before;
+    check(move == 0, "LinearExpr move assignment", move);
+
+    LinearConstr constraint(e1);
+    before = allocations;
+    LinearConstr copied_constraint(constraint);
+    copy = allocations - before;
+    before = allocations;
+    LinearConstr moved_constraint(std::move(copied_constraint));
+    move = allocations - before;
+    check(copy > 0, "LinearConstr copy", copy);
+    check(move == 0, "LinearConstr move", move);
+    check(moved_constraint.getID() == constraint.getID() && moved_constraint.getName() == constraint.getName(), "LinearConstr move keeps the id and the name", move);
+
+    QuadraticExpr q = QuadraticExpr(QuadraticTerm(1.0, 0, 0, m.getVariableAtIndex(0))) + QuadraticExpr(QuadraticTerm(2.0, 1.0, 0, m.getVariableAtIndex(2)));
+    before = allocations;
+    QuadraticExpr copied_q(q);
+    copy = allocations - before;
+    before = allocations;
+    QuadraticExpr moved_q(std::move(copied_q));
+    move = allocations - before;
+    check(copy > 0, "QuadraticExpr copy", copy);
+    check(move == 0, "QuadraticExpr move", move);
+
+    LinearConstr range = 0 <= e1 - e2 <= 4;
+    before = allocations;
+    m.addConstraint(range);
+    copy = allocations - before;
+    before = allocations;
+    m.addConstraint(std::move(range));
+    move = allocations - before;
+    check(move < copy, "Model::addConstraint move (copy " + std::to_string(copy) + ")", move);
+
+    before = allocations;
+    LinearConstr chained = 0 <= e1 - e2 <= 4;
+    size_t chain = allocations - before;
+    before = allocations;
+    LinearConstr single = e1 - e2 <= 4;
+    size_t one_side = allocations - before;
+    check(chain == one_side, "0 <= e1 - e2 <= 4 reuses the constraint of e1 - e2 <= 4 (" + std::to_string(one_side) + ")", chain);
+
+    VarStorage storage, other_storage;
+    for (int i = 0; i < 100; i++){
+        storage.emplace_back();
+        other_storage.emplace_back();
+    }
+    const Var* first = &storage[0];
+    before = allocations;
+    VarStorage copied_storage;
+    copied_storage = storage;
+    copy = allocations - before;
+    before = allocations;
+    other_storage = std::move(storage);
+    move = allocations - before;
+    check(copy > 0, "VarStorage copy assignment", copy);
+    check(move == 0 && &other_storage[0] == first && other_storage.size() == 100 && storage.size() == 0, "VarStorage move assignment keeps the Var in place", move);
+
+    std::cout << (failures == 0 ? "All checks passed" : std::to_string(failures) + " checks failed") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
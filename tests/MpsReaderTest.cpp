@@ -0,0 +1,459 @@
+/*! \brief Problems read by MpsReader, and the model left untouched by the reads that fail
+
+    The same problem is written in the free and in the fixed format, with LF and CRLF ends of line, with the OBJSENSE on the
+    header line and on the next one, and read from text and from a stream : every read must give the same model. The bounds of
+    the rows (RHS and RANGES on E, L and G rows), the bounds and domains of the columns (every bound type and the integer markers)
+    and the objective are checked against the values of the file. Files with a name already in the model, an unknown objective
+    sense or a malformed line must throw std::invalid_argument with the line of the error, and leave the model as it was.
+    A file whose COLUMNS section is cut in several chunks by read(path), with columns split between chunks, a column met again
+    further on and an integer block over whole chunks, must give the model of read(istream) at every thread count, and of two
+    errors in different chunks the one reported must be the first of the file, at its line.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Model.hpp"
+#include "MpsReader.hpp"
+#include "Parallel.hpp"
+
+using namespace Osi2;
+
+namespace {
+
+const double inf = std::numeric_limits<double>::infinity();
+
+int failures = 0;
+
+/// Count a failed check, and print the first ones
+void check(bool condition, const std::string& what){
+    if (!condition){
+        if (failures < 10){
+            std::cout << "FAILED  " << what << std::endl;
+        }
+        ++failures;
+    }
+}
+
+/// What a read puts in a model : the names and domains of the variables, the names of the constraints, the CSR arrays and the objective
+struct Snapshot {
+    std::vector<std::string> var_names;
+    std::vector<Var::Domaine> domains;
+    std::vector<std::string> constraint_names;
+    SparseMatrix csr;
+    bool maximize = false;
+};
+
+Snapshot snapshot(const Model& m, const std::string& objective){
+    Snapshot ret_val;
+    for (auto v = m.varsIteratorBegin(); v != m.varsIteratorEnd(); ++v){
+        ret_val.var_names.push_back(v->getName());
+        ret_val.domains.push_back(v->getDomaine());
+    }
+    for (auto c = m.constraintsIteratorBegin(); c != m.constraintsIteratorEnd(); ++c){
+        ret_val.constraint_names.push_back((*c)->getName());
+    }
+    ret_val.csr = m.toCSR(objective);
+    ret_val.maximize = !objective.empty() && m.getObjectiveFun(objective).type == Objective::Type::MAXIMIZE;
+    return ret_val;
+}
+
+bool operator==(const Snapshot& a, const Snapshot& b){
+    return a.var_names == b.var_names && a.domains == b.domains && a.constraint_names == b.constraint_names && a.maximize == b.maximize &&
+           a.csr.row_count == b.csr.row_count && a.csr.col_count == b.csr.col_count && a.csr.start == b.csr.start && a.csr.index == b.csr.index &&
+           a.csr.value == b.csr.value && a.csr.row_lower == b.csr.row_lower && a.csr.row_upper == b.csr.row_upper &&
+           a.csr.col_lower == b.csr.col_lower && a.csr.col_upper == b.csr.col_upper && a.csr.objective == b.csr.objective;
+}
+
+/// Builder of the text of an MPS file, in the free or the fixed format
+class MpsText {
+    public:
+        MpsText(MpsReader::Format format, bool crlf) : format(format), crlf(crlf) {}
+
+        /// Add a section header, or any line written as is
+        MpsText& header(const std::string& line){
+            text += line + (crlf ? "\r\n" : "\n");
+            return *this;
+        }
+
+        /// Add a data line given its six fields, at their columns in the fixed format and separated by blanks in the free one
+        MpsText& data(const std::string& f0, const std::string& f1, const std::string& f2 = "", const std::string& f3 = "",
+                      const std::string& f4 = "", const std::string& f5 = ""){
+            const std::string fields[6] = { f0, f1, f2, f3, f4, f5 };
+            static const size_t begins[6] = { 1, 4, 14, 24, 39, 49 };
+            std::string line;
+            for (size_t k = 0; k < 6; k++){
+                if (fields[k].empty()){
+                    continue;
+                }
+                if (format == MpsReader::Format::FIXED){
+                    line.resize(begins[k], ' ');
+                }
+                else{
+                    line += "  ";
+                }
+                line += fields[k];
+            }
+            return header(line);
+        }
+
+        const std::string& str() const { return text; }
+
+    private:
+        MpsReader::Format format;
+        bool crlf;
+        std::string text;
+};
+
+/// How the OBJSENSE section of the test problem is written
+enum class Sense { NONE, SAME_LINE, NEXT_LINE };
+
+/// The test problem : every row type with RHS and RANGES, every bound type, an integer block and an ignored N row
+std::string problem(MpsReader::Format format, Sense sense, bool crlf){
+    MpsText t(format, crlf);
+    t.header("* Test problem").header("NAME          TESTLP");
+    if (sense == Sense::SAME_LINE){
+        t.header("OBJSENSE MAX");
+    }
+    else if (sense == Sense::NEXT_LINE){
+        t.header("OBJSENSE").header("    MAXIMIZE");
+    }
+    t.header("ROWS");
+    t.data("N", "cost").data("N", "other");
+    t.data("E", "e1").data("L", "l1").data("G", "g1").data("E", "e2").data("L", "l2").data("G", "g2");
+    t.header("COLUMNS");
+    t.data("", "x1", "cost", "1", "e1", "2");
+    t.data("", "x1", "l1", "3");
+    t.data("", "MARKER", "'MARKER'", "", "'INTORG'");
+    t.data("", "y1", "cost", "-1.5", "g1", "4");
+    t.data("", "y1", "other", "9");
+    t.data("", "y2", "e2", "1e1", "l2", "+2");
+    t.data("", "MARKER", "'MARKER'", "", "'INTEND'");
+    t.data("", "x2", "e2", "5", "l2", "6");
+    t.data("", "x2", "g2", "7");
+    const char* bounded[] = { "b_up", "b_upneg", "b_lo", "b_fx", "b_fr", "b_mi", "b_pl", "b_bv", "b_li", "b_ui" };
+    for (const char* name : bounded){
+        t.data("", name, "g2", "1");
+    }
+    t.header("RHS");
+    t.data("", "RHS", "e1", "10", "l1", "20");
+    t.data("", "RHS", "g1", "30", "cost", "-4");
+    t.data("", "RHS", "e2", "1");
+    t.data("", "RHS", "l2", "2", "g2", "3");
+    t.header("RANGES");
+    t.data("", "RNG", "e1", "5", "l1", "4");
+    t.data("", "RNG", "g1", "-6", "e2", "-2");
+    t.header("BOUNDS");
+    t.data("UP", "BND", "b_up", "4");
+    t.data("UP", "BND", "b_upneg", "-5");
+    t.data("LO", "BND", "b_lo", "-3");
+    t.data("UP", "BND", "b_lo", "1e30");
+    t.data("FX", "BND", "b_fx", "2.5");
+    t.data("FR", "BND", "b_fr");
+    t.data("MI", "BND", "b_mi");
+    t.data("UP", "BND", "b_mi", "7");
+    t.data("UP", "BND", "b_pl", "3");
+    t.data("PL", "BND", "b_pl");
+    t.data("BV", "BND", "b_bv");
+    t.data("LI", "BND", "b_li", "2");
+    t.data("UI", "BND", "b_ui", "9");
+    t.header("ENDATA");
+    return t.str();
+}
+
+/// Position of a variable in the model
+size_t column(Model& m, const std::string& name){
+    return m.getVariableIndex(m.getVariable(name));
+}
+
+/// Position of a constraint in the model
+size_t row(const Model& m, const std::string& name){
+    size_t ret_val = 0;
+    for (auto c = m.constraintsIteratorBegin(); c != m.constraintsIteratorEnd() && (*c)->getName() != name; ++c){
+        ++ret_val;
+    }
+    return ret_val;
+}
+
+/// Coefficient of a column in a row of CSR arrays
+double coefficient(const SparseMatrix& csr, size_t i, size_t j){
+    for (size_t e = csr.start[i]; e < csr.start[i + 1]; e++){
+        if (csr.index[e] == j){
+            return csr.value[e];
+        }
+    }
+    return 0;
+}
+
+/// Check the model read from the test problem against the values of the file
+void checkProblem(Model& m, const MpsReader& reader, bool maximize, const std::string& name){
+    check(reader.getProblemName() == "TESTLP" && reader.getObjectiveName() == "cost", name + " : problem and objective names");
+    check(reader.getRowCount() == 6 && reader.getColumnCount() == 14 && reader.getElementCount() == 18, name + " : counts");
+    check(reader.getObjectiveConstant() == 4, name + " : objective constant");
+    check(m.getObjectiveFun("cost").type == (maximize ? Objective::Type::MAXIMIZE : Objective::Type::MINIMIZE), name + " : objective sense");
+
+    SparseMatrix csr = m.toCSR("cost");
+    struct { const char* row; double lower, upper; } rows[] = {
+        { "e1", 10, 15 }, { "l1", 16, 20 }, { "g1", 30, 36 }, { "e2", -1, 1 }, { "l2", -inf, 2 }, { "g2", 3, inf } };
+    for (const auto& r : rows){
+        size_t i = row(m, r.row);
+        check(i < csr.row_count && csr.row_lower[i] == r.lower && csr.row_upper[i] == r.upper, name + " : bounds of row " + r.row);
+    }
+
+    struct { const char* col; double lower, upper; Var::Domaine domain; } cols[] = {
+        { "x1", 0, inf, Var::Domaine::REAL }, { "y1", 0, inf, Var::Domaine::INT }, { "y2", 0, inf, Var::Domaine::INT },
+        { "x2", 0, inf, Var::Domaine::REAL }, { "b_up", 0, 4, Var::Domaine::REAL }, { "b_upneg", -inf, -5, Var::Domaine::REAL },
+        { "b_lo", -3, inf, Var::Domaine::REAL }, { "b_fx", 2.5, 2.5, Var::Domaine::REAL }, { "b_fr", -inf, inf, Var::Domaine::REAL },
+        { "b_mi", -inf, 7, Var::Domaine::REAL }, { "b_pl", 0, inf, Var::Domaine::REAL }, { "b_bv", 0, 1, Var::Domaine::BIN },
+        { "b_li", 2, inf, Var::Domaine::INT }, { "b_ui", 0, 9, Var::Domaine::INT } };
+    for (const auto& c : cols){
+        bool found = m.hasVariable(std::string(c.col));
+        size_t j = found ? column(m, c.col) : 0;
+        check(found && csr.col_lower[j] == c.lower && csr.col_upper[j] == c.upper && m.getVariable(c.col).getDomaine() == c.domain,
+              name + " : bounds and domain of column " + c.col);
+    }
+
+    check(coefficient(csr, row(m, "e1"), column(m, "x1")) == 2 && coefficient(csr, row(m, "l1"), column(m, "x1")) == 3 &&
+          coefficient(csr, row(m, "g1"), column(m, "y1")) == 4 && coefficient(csr, row(m, "e2"), column(m, "y2")) == 10 &&
+          coefficient(csr, row(m, "l2"), column(m, "y2")) == 2 && coefficient(csr, row(m, "g2"), column(m, "x2")) == 7 &&
+          coefficient(csr, row(m, "g2"), column(m, "b_ui")) == 1, name + " : coefficients");
+    check(csr.objective[column(m, "x1")] == 1 && csr.objective[column(m, "y1")] == -1.5 && csr.objective[column(m, "x2")] == 0,
+          name + " : objective coefficients");
+    check(!m.hasConstraint("other") && !m.hasObjectiveFun("other"), name + " : the second N row is ignored");
+}
+
+/// Read a problem from a stream or from text into a new model, and check it
+Snapshot readProblem(const std::string& text, MpsReader::Format format, bool stream, bool maximize, const std::string& name){
+    Model m;
+    MpsReader reader(format);
+    try{
+        if (stream){
+            std::istringstream in(text);
+            reader.read(in, m);
+        }
+        else{
+            reader.readText(text, m);
+        }
+    }
+    catch (const std::exception& e){
+        check(false, name + " : " + e.what());
+        return Snapshot();
+    }
+    checkProblem(m, reader, maximize, name);
+    return snapshot(m, "cost");
+}
+
+/// Every layout of the test problem must give the same model
+void checkFormats(){
+    Snapshot reference;
+    bool first = true;
+    for (MpsReader::Format format : { MpsReader::Format::FREE, MpsReader::Format::FIXED }){
+        for (Sense sense : { Sense::NONE, Sense::SAME_LINE, Sense::NEXT_LINE }){
+            for (bool crlf : { false, true }){
+                for (bool stream : { false, true }){
+                    std::string name = std::string(format == MpsReader::Format::FREE ? "free" : "fixed") +
+                                       (sense == Sense::NONE ? "" : sense == Sense::SAME_LINE ? ", OBJSENSE MAX" : ", OBJSENSE then MAXIMIZE") +
+                                       (crlf ? ", CRLF" : "") + (stream ? ", stream" : ", text");
+                    Snapshot s = readProblem(problem(format, sense, crlf), format, stream, sense != Sense::NONE, name);
+                    s.maximize = false; // Checked by readProblem, the rest must not depend on the sense
+                    if (first){
+                        reference = s;
+                        first = false;
+                    }
+                    check(s == reference, name + " : same model as the first read");
+                }
+            }
+        }
+    }
+
+    // The fixed format reads the fields at their columns : names may hold spaces, the last line may have no end of line
+    MpsText t(MpsReader::Format::FIXED, false);
+    t.header("NAME").header("ROWS").data("N", "obj").data("L", "my row").header("COLUMNS").data("", "my col", "obj", "1", "my row", "2");
+    t.header("RHS").data("", "RHS", "my row", "3");
+    std::string text = t.str() + "ENDATA";
+    Model m;
+    MpsReader reader(MpsReader::Format::FIXED);
+    std::istringstream in(text);
+    reader.read(in, m);
+    SparseMatrix csr = m.toCSR("obj");
+    check(m.hasVariable(std::string("my col")) && m.hasConstraint("my row") && csr.value == std::vector<double>{ 2 } &&
+          csr.row_upper == std::vector<double>{ 3 } && csr.objective == std::vector<double>{ 1 }, "fixed format : names with spaces");
+}
+
+/// A read that fails must throw std::invalid_argument with the expected message, and leave the model as it was
+void checkFailure(Model& m, const std::string& objective, const std::string& text, const std::string& message){
+    Snapshot before = snapshot(m, objective);
+    std::string what;
+    try{
+        std::istringstream in(text);
+        MpsReader().read(in, m);
+    }
+    catch (const std::invalid_argument& e){
+        what = e.what();
+    }
+    check(what == message, "error \"" + message + "\" : got \"" + what + "\"");
+    check(snapshot(m, objective) == before, "error \"" + message + "\" : the model is not modified");
+}
+
+/// Name clashes, unknown sense and malformed files, read into a model that already holds a problem
+void checkErrors(){
+    Model m;
+    uint32_t x = m.addVariable("x", Range(0, 1));
+    PackedVector coefs;
+    coefs.append(m.getVariableIndex(m[x]), 1.0);
+    coefs.seal();
+    m.addConstraint(coefs, Range(0, 1), "c");
+    m.addObjectiveFun("profit", LinearExpr(coefs, m), Objective::Type::MAXIMIZE);
+
+    const std::string head = "NAME\nROWS\n N  obj\n L  r\nCOLUMNS\n    y  obj  1  r  2\n"; // Lines 1 to 6
+    checkFailure(m, "profit", "NAME\nROWS\n N  obj\n L  c\nCOLUMNS\n    y  obj  1  c  2\nRHS\nENDATA\n",
+                 "MPS row c : the model already has a constraint of this name");
+    checkFailure(m, "profit", "NAME\nROWS\n N  obj\n L  r\nCOLUMNS\n    x  obj  1  r  2\nRHS\nENDATA\n",
+                 "MPS column x : the model already has a variable of this name");
+    checkFailure(m, "profit", "NAME\nROWS\n N  profit\n L  r\nCOLUMNS\n    y  profit  1  r  2\nENDATA\n",
+                 "MPS row profit : the model already has an objective function of this name");
+    checkFailure(m, "profit", "NAME\nOBJSENSE\n    BIGGEST\nROWS\n", "MPS line 3 : Unknown objective sense BIGGEST");
+    checkFailure(m, "profit", "NAME\nOBJSENSE MAXI\n", "MPS line 2 : Unknown objective sense MAXI");
+    checkFailure(m, "profit", head + "    z  r  abc\nENDATA\n", "MPS line 7 : Invalid number abc");
+    checkFailure(m, "profit", head + "    z  q  1\nENDATA\n", "MPS line 7 : Unknown row q");
+    checkFailure(m, "profit", head + "    z  r\nENDATA\n", "MPS line 7 : No value for row r");
+    checkFailure(m, "profit", head + "    z  r  1  r  2  r\nENDATA\n", "MPS line 7 : More than 6 fields");
+    checkFailure(m, "profit", head + "RHS\n    RHS  r  1  r  2  r\nENDATA\n", "MPS line 8 : More than 6 fields");
+    checkFailure(m, "profit", head + "    M  'MARKER'  'INTBEGIN'\nENDATA\n", "MPS line 7 : Unknown marker 'INTBEGIN'");
+    checkFailure(m, "profit", head + "RANGES\n    RNG  obj  1\nENDATA\n", "MPS line 8 : Range on the N row obj");
+    checkFailure(m, "profit", head + "BOUNDS\n UP BND z 1\nENDATA\n", "MPS line 8 : Unknown column z");
+    checkFailure(m, "profit", head + "BOUNDS\n XX BND y 1\nENDATA\n", "MPS line 8 : Unsupported bound type XX");
+    checkFailure(m, "profit", head + "BOUNDS\n UP y\nENDATA\n", "MPS line 8 : No value for the UP bound of column y");
+    checkFailure(m, "profit", head + "SOS\nENDATA\n", "MPS line 7 : Unsupported section SOS");
+    checkFailure(m, "profit", head + "ENDATA\nRHS\n", "MPS line 8 : Section RHS after ENDATA");
+    checkFailure(m, "profit", head, "MPS line 6 : The file ends without ENDATA");
+    checkFailure(m, "profit", "NAME\nROWS\n N  obj\n L  r\n L  r\n", "MPS line 5 : Duplicate row r");
+    checkFailure(m, "profit", "NAME\nROWS\n X  r\n", "MPS line 3 : Unknown row type X");
+    checkFailure(m, "profit", "NAME\n    a  b\n", "MPS line 2 : Data line outside of the ROWS, COLUMNS, RHS, RANGES and BOUNDS sections");
+
+    // A valid read after the failed ones adds the columns after the variables of the model
+    std::istringstream in(head + "RHS\n    RHS  r  5\nENDATA\n");
+    MpsReader().read(in, m);
+    SparseMatrix csr = m.toCSR("obj");
+    check(m.hasConstraint("c") && m.hasObjectiveFun("profit") && column(m, "x") == 0 && column(m, "y") == 1 && row(m, "r") == 1 &&
+          coefficient(csr, 1, 1) == 2 && csr.row_upper[1] == 5 && csr.objective[1] == 1, "read into a model that holds a problem");
+}
+
+/// A problem of 200 rows whose COLUMNS section is about 30 MB, so that read(path) cuts it in a chunk per thread up to 7 threads.
+/// The columns 20% to 70% are between integer markers. With errors, a number is invalid at 40% of the section and a row unknown at 80%,
+/// and first_error gets the line of the first one
+std::string largeProblem(size_t column_count, bool with_errors, size_t& first_error){
+    const size_t ROWS = 200;
+    const size_t LINES_PER_COLUMN = 30;
+    std::string ret_val = "NAME LARGE\nROWS\n N obj\n";
+    for (size_t i = 0; i < ROWS; i++){
+        ret_val += " L r" + std::to_string(i) + "\n";
+    }
+    ret_val += "COLUMNS\n";
+    size_t line = ROWS + 4;
+    first_error = 0;
+    for (size_t j = 0; j < column_count; j++){
+        if (j == column_count / 5 || j == column_count * 7 / 10){
+            ret_val += j == column_count / 5 ? "    M 'MARKER' 'INTORG'\n" : "    M 'MARKER' 'INTEND'\n";
+            ++line;
+        }
+        std::string name = "    c" + std::to_string(j) + " ";
+        for (size_t k = 0; k < LINES_PER_COLUMN; k++){ // Each line of the column has its own two rows
+            ++line;
+            size_t i = (j + 2 * k) % ROWS;
+            std::string value = std::to_string(int(j % 97) - 48) + "." + std::to_string(k + 1); // Never zero
+            if (with_errors && k == 0 && (j == column_count * 2 / 5 || j == column_count * 4 / 5)){
+                ret_val += name + (j == column_count * 2 / 5 ? "r0 1.2.3\n" : "q0 1\n");
+                first_error = first_error == 0 ? line : first_error;
+                continue;
+            }
+            if (k == 0 && j % 3 == 0){
+                ret_val += name + "obj " + value + "\n";
+                ++line;
+            }
+            ret_val += name + "r" + std::to_string(i) + " " + value + " r" + std::to_string((i + 1) % ROWS) + " 1\n";
+        }
+    }
+    ret_val += "    c0 obj 7 r199 -1\n"; // The first column again, merged from the last chunk
+    ret_val += "RHS\n    RHS r0 5 r1 6\nBOUNDS\n UP BND c1 4\n UP BND c" + std::to_string(column_count / 2) + " 8\nENDATA\n";
+    return ret_val;
+}
+
+/// Read a file with read(path) at several thread counts and from a stream : same model, or same first error
+void checkChunks(){
+    std::string path = (std::filesystem::temp_directory_path() / "MpsReaderTest.mps").string();
+    const size_t COLUMNS = 40000;
+
+    for (bool with_errors : { false, true }){
+        size_t first_error;
+        std::string text = largeProblem(COLUMNS, with_errors, first_error);
+        check(text.size() > 7 * (size_t(1) << 22), "large problem : the COLUMNS section holds 7 chunks of 4 MB");
+        std::ofstream(path, std::ios::binary) << text;
+
+        std::string name = with_errors ? "large problem with errors" : "large problem";
+        std::string expected_error = with_errors ? "MPS line " + std::to_string(first_error) + " : Invalid number 1.2.3" : "";
+        Snapshot reference;
+        for (size_t threads : { 0, 1, 2, 3, 4, 7 }){ // 0 reads the stream
+            setThreadCount(std::max(size_t(1), threads));
+            Model m;
+            std::string what;
+            try{
+                if (threads == 0){
+                    std::istringstream in(text);
+                    MpsReader().read(in, m);
+                }
+                else{
+                    MpsReader().read(path, m);
+                }
+            }
+            catch (const std::invalid_argument& e){
+                what = e.what();
+            }
+            std::string run = name + (threads == 0 ? " from a stream" : " on " + std::to_string(threads) + " threads");
+            check(what == expected_error, run + " : error \"" + what + "\"");
+            if (with_errors){
+                check(m.varsIteratorBegin() == m.varsIteratorEnd() && !m.hasObjectiveFun("obj"), run + " : the model is not modified");
+                continue;
+            }
+
+            Snapshot s = snapshot(m, "obj");
+            if (threads == 0){
+                reference = s;
+                SparseMatrix& csr = s.csr;
+                size_t c0 = column(m, "c0");
+                check(s.var_names.size() == COLUMNS && csr.row_count == 200 && csr.start.back() == 60 * COLUMNS + 1, run + " : counts");
+                check(s.domains[COLUMNS / 5 - 1] == Var::Domaine::REAL && s.domains[COLUMNS / 5] == Var::Domaine::INT &&
+                      s.domains[COLUMNS / 2] == Var::Domaine::INT && s.domains[COLUMNS * 7 / 10 - 1] == Var::Domaine::INT &&
+                      s.domains[COLUMNS * 7 / 10] == Var::Domaine::REAL, run + " : integer markers");
+                check(csr.objective[c0] == -48.1 + 7 && coefficient(csr, 199, c0) == -1 && coefficient(csr, 0, c0) == -48.1,
+                      run + " : the column met again");
+                check(csr.col_upper[1] == 4 && csr.col_upper[COLUMNS / 2] == 8 && csr.row_upper[0] == 5 && csr.row_upper[1] == 6,
+                      run + " : RHS and BOUNDS after the COLUMNS section");
+            }
+            else{
+                check(s == reference, run + " : same model as the stream");
+            }
+        }
+    }
+    setThreadCount(0);
+    std::remove(path.c_str());
+}
+
+}
+
+int main(){
+    checkFormats();
+    checkErrors();
+    checkChunks();
+
+    std::cout << (failures == 0 ? "All checks passed" : std::to_string(failures) + " checks failed") << std::endl;
+    return failures == 0 ? 0 : 1;
+}